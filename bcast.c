@@ -0,0 +1,217 @@
+/*
+ * bcast.c
+ *
+ * broadcast channels, see bcast.h
+ */
+
+#include <ylib.h>
+#include "bcast.h"
+#include "kernel.h"
+#include "include.h"
+
+// channel with id BCAST_ID_BASE + i lives at index i
+static bcast_t *bcast_channels[MAX_BCASTS];
+
+/**
+ * @brief creates a channel
+ * 
+ * @param policy BCAST_BLOCK or BCAST_DROP
+ * @return int id of the channel, ERROR otherwise
+ */
+int bcast_create(int policy) {
+    if (policy != BCAST_BLOCK && policy != BCAST_DROP) return ERROR;
+
+    int slot = -1;
+    for (int i = 0; i < MAX_BCASTS; i++) {
+        if (bcast_channels[i] == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == -1) return ERROR;
+
+    bcast_t *bc = ReclaimingMalloc(sizeof(bcast_t));
+    if (bc == NULL) return ERROR;
+    memset(bc, 0, sizeof(bcast_t));
+    bc->readers = queue_init();
+    bc->writers = queue_init();
+    if (bc->readers == NULL || bc->writers == NULL) {
+        free(bc);
+        return ERROR;
+    }
+    bc->id = BCAST_ID_BASE + slot;
+    bc->policy = policy;
+    bcast_channels[slot] = bc;
+    return bc->id;
+}
+
+/**
+ * @brief Get the channel object
+ * 
+ * @param id 
+ * @return bcast_t* NULL if there's no channel with id
+ */
+bcast_t *get_bcast(int id) {
+    if (id < BCAST_ID_BASE || id >= BCAST_ID_BASE + MAX_BCASTS) return NULL;
+    return bcast_channels[id - BCAST_ID_BASE];
+}
+
+/**
+ * @brief subscribes pid to bc, starting at the next byte written
+ * 
+ * @param bc 
+ * @param pid 
+ * @return int 0 if success, ERROR if already subscribed or bc is full
+ */
+int bcast_subscribe(bcast_t *bc, int pid) {
+    if (bcast_get_sub(bc, pid) != NULL) return ERROR;
+    for (int i = 0; i < MAX_BCAST_SUBS; i++) {
+        bcast_sub_t *sub = &bc->subs[i];
+        if (!sub->used) {
+            sub->used = 1;
+            sub->pid = pid;
+            sub->pos = bc->head;
+            sub->lost = 0;
+            return 0;
+        }
+    }
+    return ERROR;
+}
+
+/**
+ * @brief drops pid's subscription, writers waiting on it get to retry
+ * 
+ * @param bc 
+ * @param pid 
+ * @return int 0 if success, ERROR if pid wasn't subscribed
+ */
+int bcast_unsubscribe(bcast_t *bc, int pid) {
+    bcast_sub_t *sub = bcast_get_sub(bc, pid);
+    if (sub == NULL) return ERROR;
+    sub->used = 0;
+    bcast_wake(bc->writers);
+    return 0;
+}
+
+/**
+ * @brief Get pid's subscription to bc, with lost bytes accounted for
+ * 
+ * @param bc 
+ * @param pid 
+ * @return bcast_sub_t* NULL if pid isn't subscribed
+ */
+bcast_sub_t *bcast_get_sub(bcast_t *bc, int pid) {
+    for (int i = 0; i < MAX_BCAST_SUBS; i++) {
+        bcast_sub_t *sub = &bc->subs[i];
+        if (sub->used && sub->pid == pid) {
+            // bytes older than the ring are gone, skip the cursor past them
+            if (bc->head - sub->pos > BCAST_BUFFER_LEN) {
+                unsigned int oldest = bc->head - BCAST_BUFFER_LEN;
+                sub->lost += oldest - sub->pos;
+                sub->pos = oldest;
+            }
+            return sub;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief how many bytes can be written without overwriting a byte some
+ * subscriber hasn't read
+ * 
+ * @param bc 
+ * @return int 
+ */
+int bcast_space(bcast_t *bc) {
+    unsigned int behind = 0;
+    for (int i = 0; i < MAX_BCAST_SUBS; i++) {
+        if (bc->subs[i].used && bc->head - bc->subs[i].pos > behind) {
+            behind = bc->head - bc->subs[i].pos;
+        }
+    }
+    return BCAST_BUFFER_LEN - behind;
+}
+
+/**
+ * @brief appends len bytes to the ring, overwriting the oldest if needed
+ * 
+ * @param bc 
+ * @param buf 
+ * @param len 
+ */
+void bcast_put(bcast_t *bc, char *buf, int len) {
+    // only the last BCAST_BUFFER_LEN bytes of a huge write can survive
+    if (len > BCAST_BUFFER_LEN) {
+        bc->head += len - BCAST_BUFFER_LEN;
+        buf += len - BCAST_BUFFER_LEN;
+        len = BCAST_BUFFER_LEN;
+    }
+    int start = bc->head % BCAST_BUFFER_LEN;
+    int first = BCAST_BUFFER_LEN - start < len ? BCAST_BUFFER_LEN - start : len;
+    memcpy(bc->buf + start, buf, first);
+    memcpy(bc->buf, buf + first, len - first);
+    bc->head += len;
+}
+
+/**
+ * @brief copies up to len unread bytes out for sub and advances its cursor
+ * 
+ * @param bc 
+ * @param sub 
+ * @param buf 
+ * @param len 
+ * @return int bytes copied
+ */
+int bcast_get(bcast_t *bc, bcast_sub_t *sub, char *buf, int len) {
+    int avail = bc->head - sub->pos;
+    if (len > avail) len = avail;
+
+    int start = sub->pos % BCAST_BUFFER_LEN;
+    int first = BCAST_BUFFER_LEN - start < len ? BCAST_BUFFER_LEN - start : len;
+    memcpy(buf, bc->buf + start, first);
+    memcpy(buf + first, bc->buf, len - first);
+    sub->pos += len;
+    return len;
+}
+
+/**
+ * @brief moves every process in q to the ready queue
+ * 
+ * @param q 
+ */
+void bcast_wake(queue_t *q) {
+    while (q->size > 0) {
+        pcb_t *pcb = queue_pop(q);
+        pcb->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, pcb, pcb->pid);
+    }
+}
+
+/**
+ * @brief frees the channel
+ * 
+ * @param id 
+ * @return int 0 if success, ERROR if it doesn't exist or has blocked processes
+ */
+int bcast_reclaim(int id) {
+    bcast_t *bc = get_bcast(id);
+    if (bc == NULL || bc->readers->size > 0 || bc->writers->size > 0) return ERROR;
+
+    queue_delete(bc->readers, NULL);
+    queue_delete(bc->writers, NULL);
+    free(bc);
+    bcast_channels[id - BCAST_ID_BASE] = NULL;
+    return 0;
+}
+
+/**
+ * @brief drops every subscription held by an exiting process
+ * 
+ * @param pid 
+ */
+void bcast_exit(int pid) {
+    for (int i = 0; i < MAX_BCASTS; i++) {
+        if (bcast_channels[i] != NULL) bcast_unsubscribe(bcast_channels[i], pid);
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef __BCAST_H_
+#define __BCAST_H_
+
+#include "process.h"
+#include "queue.h"
+
+/*
+ * bcast.h
+ *
+ * broadcast channels: a writer appends each byte once into a ring, and every
+ * subscribed process reads it through its own cursor. Positions count bytes
+ * since the channel was created, byte n lives at buf[n % BCAST_BUFFER_LEN].
+ * When the ring is full, a BCAST_BLOCK channel makes the writer wait for the
+ * slowest subscriber, a BCAST_DROP channel overwrites the oldest bytes and
+ * counts them as lost for whoever hadn't read them yet.
+ */
+
+#define BCAST_BUFFER_LEN 1024
+#define MAX_BCAST_SUBS 16
+
+typedef struct bcast_sub {
+    int used;
+    int pid;
+    unsigned int pos;       // next byte this subscriber reads
+    unsigned int lost;      // bytes overwritten before it read them
+} bcast_sub_t;
+
+typedef struct bcast {
+    int id;
+    int policy;             // BCAST_BLOCK or BCAST_DROP
+    char buf[BCAST_BUFFER_LEN];
+    unsigned int head;      // bytes ever written
+    bcast_sub_t subs[MAX_BCAST_SUBS];
+    queue_t *readers;       // subscribers waiting for new bytes
+    queue_t *writers;       // writers waiting for room (BCAST_BLOCK only)
+} bcast_t;
+
+/**
+ * @brief creates a channel
+ * 
+ * @param policy BCAST_BLOCK or BCAST_DROP
+ * @return int id of the channel, ERROR otherwise
+ */
+int bcast_create(int policy);
+
+/**
+ * @brief Get the channel object
+ * 
+ * @param id 
+ * @return bcast_t* NULL if there's no channel with id
+ */
+bcast_t *get_bcast(int id);
+
+/**
+ * @brief subscribes pid to bc, starting at the next byte written
+ * 
+ * @param bc 
+ * @param pid 
+ * @return int 0 if success, ERROR if already subscribed or bc is full
+ */
+int bcast_subscribe(bcast_t *bc, int pid);
+
+/**
+ * @brief drops pid's subscription, writers waiting on it get to retry
+ * 
+ * @param bc 
+ * @param pid 
+ * @return int 0 if success, ERROR if pid wasn't subscribed
+ */
+int bcast_unsubscribe(bcast_t *bc, int pid);
+
+/**
+ * @brief Get pid's subscription to bc, with lost bytes accounted for
+ * 
+ * @param bc 
+ * @param pid 
+ * @return bcast_sub_t* NULL if pid isn't subscribed
+ */
+bcast_sub_t *bcast_get_sub(bcast_t *bc, int pid);
+
+/**
+ * @brief how many bytes can be written without overwriting a byte some
+ * subscriber hasn't read
+ * 
+ * @param bc 
+ * @return int 
+ */
+int bcast_space(bcast_t *bc);
+
+/**
+ * @brief appends len bytes to the ring, overwriting the oldest if needed
+ * 
+ * @param bc 
+ * @param buf 
+ * @param len 
+ */
+void bcast_put(bcast_t *bc, char *buf, int len);
+
+/**
+ * @brief copies up to len unread bytes out for sub and advances its cursor
+ * 
+ * @param bc 
+ * @param sub 
+ * @param buf 
+ * @param len 
+ * @return int bytes copied
+ */
+int bcast_get(bcast_t *bc, bcast_sub_t *sub, char *buf, int len);
+
+/**
+ * @brief moves every process in q to the ready queue
+ * 
+ * @param q 
+ */
+void bcast_wake(queue_t *q);
+
+/**
+ * @brief frees the channel
+ * 
+ * @param id 
+ * @return int 0 if success, ERROR if it doesn't exist or has blocked processes
+ */
+int bcast_reclaim(int id);
+
+/**
+ * @brief drops every subscription held by an exiting process
+ * 
+ * @param pid 
+ */
+void bcast_exit(int pid);
+
+#endif
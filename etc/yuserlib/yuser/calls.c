@@ -137,7 +137,7 @@ int Send (void *a, int b) {
 }
 
 int Receive (void * a) {
-  YSYSCALL(YALNIX_RECEIVE, 0, 0, 0, 0);
+  YSYSCALL(YALNIX_RECEIVE, a, 0, 0, 0);
 }
 
 int ReceiveSpecific (void *a, int b) {
@@ -192,6 +192,18 @@ int SemDown(int a) {
   YSYSCALL(YALNIX_SEM_DOWN, a, 0, 0, 0);
 }
 
+int SemUpN(int a, int b) {
+  YSYSCALL(YALNIX_SEM_UP_N, a, b, 0, 0);
+}
+
+int SemDownN(int a, int b) {
+  YSYSCALL(YALNIX_SEM_DOWN_N, a, b, 0, 0);
+}
+
+int SemTryDown(int a) {
+  YSYSCALL(YALNIX_SEM_TRY_DOWN, a, 0, 0, 0);
+}
+
 int LockInit(int *a) {
   YSYSCALL(YALNIX_LOCK_INIT, a, 0, 0, 0);
 }
@@ -227,6 +239,184 @@ int Reclaim(int a) {
   YSYSCALL(YALNIX_RECLAIM, a, 0, 0, 0);
 }
 
+int ShmInit(int *a, int b) {
+  YSYSCALL(YALNIX_SHM_INIT, a, b, 0, 0);
+}
+
+int ShmAttach(int a, void **b) {
+  YSYSCALL(YALNIX_SHM_ATTACH, a, b, 0, 0);
+}
+
+int ShmDetach(void *a) {
+  YSYSCALL(YALNIX_SHM_DETACH, a, 0, 0, 0);
+}
+
+int FutexWait(int *a, int b) {
+  YSYSCALL(YALNIX_FUTEX_WAIT, a, b, 0, 0);
+}
+
+int FutexWake(int *a, int b) {
+  YSYSCALL(YALNIX_FUTEX_WAKE, a, b, 0, 0);
+}
+
+int Poll(void *a, int b, int c) {
+  YSYSCALL(YALNIX_POLL, a, b, c, 0);
+}
+
+int RingSetup(void **a) {
+  YSYSCALL(YALNIX_RING_SETUP, a, 0, 0, 0);
+}
+
+int RingEnter(int a) {
+  YSYSCALL(YALNIX_RING_ENTER, a, 0, 0, 0);
+}
+
+int PipeReadv(int a, void *b, int c) {
+  YSYSCALL(YALNIX_PIPE_READV, a, b, c, 0);
+}
+
+int PipeWritev(int a, void *b, int c) {
+  YSYSCALL(YALNIX_PIPE_WRITEV, a, b, c, 0);
+}
+
+int TtyWritev(int a, void *b, int c) {
+  YSYSCALL(YALNIX_TTY_WRITEV, a, b, c, 0);
+}
+
+int PipeSetLowat(int a, int b, int c) {
+  YSYSCALL(YALNIX_PIPE_LOWAT, a, b, c, 0);
+}
+
+int BcastInit(int *a, int b) {
+  YSYSCALL(YALNIX_BCAST_INIT, a, b, 0, 0);
+}
+
+int BcastSubscribe(int a) {
+  YSYSCALL(YALNIX_BCAST_SUBSCRIBE, a, 0, 0, 0);
+}
+
+int BcastUnsubscribe(int a) {
+  YSYSCALL(YALNIX_BCAST_UNSUBSCRIBE, a, 0, 0, 0);
+}
+
+int BcastWrite(int a, void *b, int c) {
+  YSYSCALL(YALNIX_BCAST_WRITE, a, b, c, 0);
+}
+
+int BcastRead(int a, void *b, int c) {
+  YSYSCALL(YALNIX_BCAST_READ, a, b, c, 0);
+}
+
+int BcastLost(int a) {
+  YSYSCALL(YALNIX_BCAST_LOST, a, 0, 0, 0);
+}
+
+int MsgqInit(int *a, int b) {
+  YSYSCALL(YALNIX_MSGQ_INIT, a, b, 0, 0);
+}
+
+int MsgqSend(int a, void *b, int c, int d) {
+  YSYSCALL(YALNIX_MSGQ_SEND, a, b, c, d);
+}
+
+int MsgqReceive(int a, void *b, int c, int *d) {
+  YSYSCALL(YALNIX_MSGQ_RECEIVE, a, b, c, d);
+}
+
+int Splice(int a, int b) {
+  YSYSCALL(YALNIX_SPLICE, a, b, 0, 0);
+}
+
+int Tee(int a, int b) {
+  YSYSCALL(YALNIX_TEE, a, b, 0, 0);
+}
+
+int TryAcquire(int a) {
+  YSYSCALL(YALNIX_LOCK_TRY_ACQUIRE, a, 0, 0, 0);
+}
+
+int AcquireTimeout(int a, int b) {
+  YSYSCALL(YALNIX_LOCK_ACQUIRE_TIMEOUT, a, b, 0, 0);
+}
+
+int LockStats(int a, void *b) {
+  YSYSCALL(YALNIX_LOCK_STATS, a, b, 0, 0);
+}
+
+int RWLockInit(int *a) {
+  YSYSCALL(YALNIX_RWLOCK_INIT, a, 0, 0, 0);
+}
+
+int RWLockRead(int a) {
+  YSYSCALL(YALNIX_RWLOCK_READ, a, 0, 0, 0);
+}
+
+int RWLockWrite(int a) {
+  YSYSCALL(YALNIX_RWLOCK_WRITE, a, 0, 0, 0);
+}
+
+int RWLockRelease(int a) {
+  YSYSCALL(YALNIX_RWLOCK_RELEASE, a, 0, 0, 0);
+}
+
+int BarrierInit(int *a, int b) {
+  YSYSCALL(YALNIX_BARRIER_INIT, a, b, 0, 0);
+}
+
+int BarrierWait(int a) {
+  YSYSCALL(YALNIX_BARRIER_WAIT, a, 0, 0, 0);
+}
+
+int CvarWaitTimeout(int a, int b, int c) {
+  YSYSCALL(YALNIX_CVAR_WAIT_TIMEOUT, a, b, c, 0);
+}
+
+int PipeReadTimeout(int a, void *b, int c, int d) {
+  YSYSCALL(YALNIX_PIPE_READ_TIMEOUT, a, b, c, d);
+}
+
+int TtySetMode(int a, int b, int c) {
+  YSYSCALL(YALNIX_TTY_SET_MODE, a, b, c, 0);
+}
+
+int TtyWriteStats(int a, void *b) {
+  YSYSCALL(YALNIX_TTY_WRITE_STATS, a, b, 0, 0);
+}
+
+int TtyReadTimeout(int a, void *b, int c, int d) {
+  YSYSCALL(YALNIX_TTY_READ_TIMEOUT, a, b, c, d);
+}
+
+int ExecCacheStats(void *a) {
+  YSYSCALL(YALNIX_EXEC_CACHE_STATS, a, 0, 0, 0);
+}
+
+int Spawn(char *a, char **b) {
+  YSYSCALL(YALNIX_SPAWN, a, b, 0, 0);
+}
+
+void ThreadExit(int a) {
+  YSYSCALL_NR(YALNIX_THREAD_EXIT, a, 0, 0, 0);
+  // should not return...
+}
+
+// every thread starts here, so returning from func ends the thread
+static void thread_start(int (*func)(void *), void *arg) {
+  ThreadExit(func(arg));
+}
+
+int ThreadCreate(int (*a)(void *), void *b) {
+  YSYSCALL(YALNIX_THREAD_CREATE, thread_start, a, b, 0);
+}
+
+int ThreadJoin(int a, int *b) {
+  YSYSCALL(YALNIX_THREAD_JOIN, a, b, 0, 0);
+}
+
+int WaitPid(int a, int *b, int c) {
+  YSYSCALL(YALNIX_WAIT_PID, a, b, c, 0);
+}
+
 int Custom0 (int a, int b, int c, int d) {
   YSYSCALL(YALNIX_CUSTOM_0, a, b, c, d);
 }
@@ -0,0 +1,36 @@
+/*
+ * ring.c: helpers for the submission ring set up by RingSetup.
+ *
+ * RingPush queues an operation, RingSubmit hands everything queued to the
+ * kernel in one RingEnter trap, and RingPop takes completions off in order.
+ */
+
+#include "yuser.h"
+
+int RingPush(ring_t *ring, int op, int id, void *buf, int len, int user_data) {
+  if (ring == NULL) return ERROR;
+  if (ring->sq_tail - ring->sq_head >= RING_ENTRIES) return WOULD_BLOCK;
+
+  ring_sqe_t *sqe = &ring->sq[ring->sq_tail % RING_ENTRIES];
+  sqe->op = op;
+  sqe->id = id;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->user_data = user_data;
+  ring->sq_tail++;
+  return 0;
+}
+
+int RingSubmit(ring_t *ring) {
+  if (ring == NULL) return ERROR;
+  return RingEnter(ring->sq_tail - ring->sq_head);
+}
+
+int RingPop(ring_t *ring, ring_cqe_t *cqe) {
+  if (ring == NULL || cqe == NULL) return ERROR;
+  if (ring->cq_head == ring->cq_tail) return WOULD_BLOCK;
+
+  *cqe = ring->cq[ring->cq_head % RING_ENTRIES];
+  ring->cq_head++;
+  return 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * ulock.c: user-space lock on top of FutexWait/FutexWake.
+ *
+ * state is 0 (free), 1 (held, no waiters) or 2 (held, maybe waiters).
+ * An uncontended Acquire/Release is a single compare-and-swap each and never
+ * enters the kernel; only a contended lock sleeps in FutexWait, and Release
+ * only calls FutexWake when the state says someone might be sleeping.
+ */
+
+#include "yuser.h"
+
+int ULockInit(ulock_t *lock) {
+  if (lock == NULL) return ERROR;
+  lock->state = 0;
+  return 0;
+}
+
+int ULockAcquire(ulock_t *lock) {
+  if (lock == NULL) return ERROR;
+
+  int c = __sync_val_compare_and_swap(&lock->state, 0, 1);
+  if (c == 0) return 0;
+
+  // contended: mark the lock as having waiters, then sleep until it's free
+  do {
+    if (c == 2 || __sync_val_compare_and_swap(&lock->state, 1, 2) != 0) {
+      if (FutexWait((int *) &lock->state, 2) == ERROR) return ERROR;
+    }
+  } while ((c = __sync_val_compare_and_swap(&lock->state, 0, 2)) != 0);
+  return 0;
+}
+
+int ULockRelease(ulock_t *lock) {
+  if (lock == NULL || lock->state == 0) return ERROR;
+
+  if (__sync_fetch_and_sub(&lock->state, 1) != 1) {
+    lock->state = 0;
+    if (FutexWake((int *) &lock->state, 1) == ERROR) return ERROR;
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * image.c
+ *
+ * executable image cache, see image.h
+ */
+
+#include <ylib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "image.h"
+#include "kernel.h"
+#include "include.h"
+
+// most recently used first
+static image_t *image_head = NULL;
+static image_t *image_tail = NULL;
+static exec_cache_stats_t cache_stats;
+
+/**
+ * @brief takes img out of the LRU list
+ * 
+ * @param img 
+ */
+static void image_unlink(image_t *img) {
+    if (img->prev != NULL) img->prev->next = img->next;
+    else image_head = img->next;
+    if (img->next != NULL) img->next->prev = img->prev;
+    else image_tail = img->prev;
+    img->prev = NULL;
+    img->next = NULL;
+}
+
+/**
+ * @brief puts img at the front of the LRU list
+ * 
+ * @param img 
+ */
+static void image_push(image_t *img) {
+    img->prev = NULL;
+    img->next = image_head;
+    if (image_head != NULL) image_head->prev = img;
+    image_head = img;
+    if (image_tail == NULL) image_tail = img;
+}
+
+/**
+ * @brief frees an image and everything it holds
+ * 
+ * @param img 
+ */
+static void image_free(image_t *img) {
+    free(img->path);
+    free(img->text);
+    free(img->data);
+    free(img);
+}
+
+/**
+ * @brief drops the least recently used image that isn't in use
+ * 
+ * @return int 1 if an image was dropped, 0 if there was none to drop
+ */
+int image_evict(void) {
+    image_t *victim = image_tail;
+    while (victim != NULL && victim->in_use) victim = victim->prev;
+    if (victim == NULL) return 0;
+
+    image_unlink(victim);
+    cache_stats.pages -= victim->npg;
+    cache_stats.entries--;
+    cache_stats.evictions++;
+    image_free(victim);
+    return 1;
+}
+
+/**
+ * @brief parses the open executable and reads its text and data into img
+ * 
+ * @param img 
+ * @param fd 
+ * @param path 
+ * @return int 0 if success, ERROR otherwise
+ */
+static int image_fill(image_t *img, int fd, char *path) {
+    if (LoadInfo(fd, &img->li) != LI_NO_ERROR) {
+        TracePrintf(0, "image_read: '%s' not in Yalnix format\n", path);
+        return ERROR;
+    }
+    if (img->li.entry < VMEM_1_BASE) {
+        TracePrintf(0, "image_read: '%s' not linked for Yalnix\n", path);
+        return ERROR;
+    }
+
+    long text_size = img->li.t_npg << PAGESHIFT;
+    long data_size = img->li.id_npg << PAGESHIFT;
+    img->path = ReclaimingMalloc(strlen(path) + 1);
+    img->text = ReclaimingMalloc(text_size);
+    img->data = ReclaimingMalloc(data_size);
+    if (img->path == NULL || img->text == NULL || img->data == NULL) {
+        TracePrintf(0, "image_read: no memory for '%s'\n", path);
+        return ERROR;
+    }
+    strcpy(img->path, path);
+
+    if (lseek(fd, img->li.t_faddr, SEEK_SET) < 0 || read(fd, img->text, text_size) != text_size ||
+        lseek(fd, img->li.id_faddr, SEEK_SET) < 0 || read(fd, img->data, data_size) != data_size) {
+        TracePrintf(0, "image_read: short read from '%s'\n", path);
+        return ERROR;
+    }
+    img->npg = img->li.t_npg + img->li.id_npg;
+    return 0;
+}
+
+/**
+ * @brief reads a whole executable out of its file
+ * 
+ * @param path 
+ * @param mtime 
+ * @return image_t* NULL if it can't be read or isn't a Yalnix executable
+ */
+static image_t *image_read(char *path, time_t mtime) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        TracePrintf(0, "image_read: can't open file '%s'\n", path);
+        return NULL;
+    }
+
+    image_t *img = ReclaimingMalloc(sizeof(image_t));
+    if (img != NULL) {
+        memset(img, 0, sizeof(image_t));
+        img->mtime = mtime;
+        if (image_fill(img, fd, path) == ERROR) {
+            image_free(img);
+            img = NULL;
+        }
+    }
+    close(fd);
+    return img;
+}
+
+/**
+ * @brief finds the image for path in the cache, or reads it from the file
+ * and caches it
+ * 
+ * @param path 
+ * @return image_t* NULL if the file can't be read or isn't a Yalnix executable
+ */
+image_t *image_get(char *path) {
+    struct stat st;
+    if (stat(path, &st) < 0) {
+        TracePrintf(0, "image_get: can't stat file '%s'\n", path);
+        return NULL;
+    }
+
+    for (image_t *img = image_head; img != NULL; img = img->next) {
+        if (strcmp(img->path, path) != 0) continue;
+        if (img->mtime == st.st_mtime) {
+            cache_stats.hits++;
+            image_unlink(img);
+            image_push(img);
+            img->in_use = 1;
+            return img;
+        }
+        // the file changed since we read it
+        image_unlink(img);
+        cache_stats.pages -= img->npg;
+        cache_stats.entries--;
+        image_free(img);
+        break;
+    }
+
+    cache_stats.misses++;
+    image_t *img = image_read(path, st.st_mtime);
+    if (img == NULL) return NULL;
+    img->in_use = 1;
+    if (img->npg > IMAGE_CACHE_PAGES) return img;
+
+    // make room by dropping the least recently used
+    while (cache_stats.pages + img->npg > IMAGE_CACHE_PAGES) {
+        if (!image_evict()) return img;
+    }
+    img->cached = 1;
+    image_push(img);
+    cache_stats.pages += img->npg;
+    cache_stats.entries++;
+    return img;
+}
+
+/**
+ * @brief done with an image from image_get
+ * 
+ * @param img 
+ */
+void image_put(image_t *img) {
+    if (img == NULL) return;
+    img->in_use = 0;
+    if (!img->cached) image_free(img);
+}
+
+/**
+ * @brief copies out the cache's counters
+ * 
+ * @param statsp 
+ */
+void image_stats(exec_cache_stats_t *statsp) {
+    *statsp = cache_stats;
+}
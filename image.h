@@ -0,0 +1,67 @@
+#ifndef __IMAGE_H_
+#define __IMAGE_H_
+
+#include <hardware.h>
+#include <load_info.h>
+#include <sys/types.h>
+#include <yalnix.h>
+
+/*
+ * image.h
+ *
+ * cache of executable images for Exec: the parsed load_info and the text
+ * and initialized data pages of recently loaded programs, keyed by path and
+ * the file's modification time, so running the same binary again needs no
+ * reads from the host file. Entries are kept most recently used first and
+ * the least recently used are dropped to stay within IMAGE_CACHE_PAGES.
+ * The cache lives in the kernel heap, which shares region 0 with everything
+ * else, so it stays small and gives images back whenever a kernel malloc
+ * fails, see ReclaimingMalloc.
+ */
+
+#define IMAGE_CACHE_PAGES 8
+
+typedef struct image {
+    char *path;
+    time_t mtime;           // modification time of the file when it was read
+    struct load_info li;
+    char *text;             // li.t_npg pages
+    char *data;             // li.id_npg pages
+    int npg;                // pages of text and data held
+    int cached;             // 0 for an image too big to keep, freed by image_put
+    int in_use;             // between image_get and image_put, can't be evicted
+    struct image *prev;
+    struct image *next;
+} image_t;
+
+/**
+ * @brief finds the image for path in the cache, or reads it from the file
+ * and caches it
+ * 
+ * @param path 
+ * @return image_t* NULL if the file can't be read or isn't a Yalnix executable
+ */
+image_t *image_get(char *path);
+
+/**
+ * @brief done with an image from image_get
+ * 
+ * @param img 
+ */
+void image_put(image_t *img);
+
+/**
+ * @brief drops the least recently used image that isn't in use
+ * 
+ * @return int 1 if an image was dropped, 0 if there was none to drop
+ */
+int image_evict(void);
+
+/**
+ * @brief copies out the cache's counters
+ * 
+ * @param statsp 
+ */
+void image_stats(exec_cache_stats_t *statsp);
+
+#endif
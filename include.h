@@ -41,6 +41,21 @@ enum {
     BLOCKED_PIPE_READ     =    6,
     BLOCKED_PIPE_WRITE    =    7,
     BLOCKED_LOCK_ACQUIRE  =    8,
+    BLOCKED_SEND          =    9,
+    BLOCKED_RECEIVE       =   10,
+    BLOCKED_REPLY         =   11,
+    BLOCKED_SEM_DOWN      =   12,
+    BLOCKED_FUTEX         =   13,
+    BLOCKED_POLL          =   14,
+    BLOCKED_BCAST_READ    =   15,
+    BLOCKED_BCAST_WRITE   =   16,
+    BLOCKED_MSGQ_SEND     =   17,
+    BLOCKED_MSGQ_RECEIVE  =   18,
+    BLOCKED_CVAR_WAIT     =   19,
+    BLOCKED_RW_READ       =   20,
+    BLOCKED_RW_WRITE      =   21,
+    BLOCKED_BARRIER       =   22,
+    BLOCKED_THREAD_JOIN   =   23,
 
     // TTY I/O 
     TERMINAL_OPEN         =    1,
@@ -48,11 +63,21 @@ enum {
 
     PIPE_FREE             =    0,
     PIPE_NOT_FREE         =    1,
+    NO_SPLICE             =   -1,   // pipe isn't spliced/teed, terminal has no spliced pipe
+
+    // MESSAGE PASSING
+    IPC_MESSAGE_SIZE      =   32,   // every Send/Receive/Reply message is 32 bytes
+    NO_SERVICE            =   -1,
     // LOCKS AND CVARS
-    UNUSED_LOCK           =    0, 
+    UNUSED_LOCK           =   -1,   // lock_status otherwise holds FREE_LOCK or the owner's pid
     FREE_LOCK             =    0,  
+    RW_READ_HELD          =   -2,   // lock_status of a reader-writer lock held by readers
+    MUTEX_LOCK            =    0,   // lock_type values
+    RW_LOCK               =    1,
     UNUSED_CVAR           =    0, 
-    USED_CVAR             =    0
+    USED_CVAR             =    1,
+    UNUSED_SEM            =    0,
+    USED_SEM              =    1
 
 };
 
@@ -82,16 +82,176 @@
 #define YALNIX_CVAR_BROADCAST   ( 0x68 | YALNIX_PREFIX)
 #define YALNIX_CVAR_WAIT        ( 0x69 | YALNIX_PREFIX)
 #define YALNIX_RECLAIM          ( 0x6A | YALNIX_PREFIX)
+#define YALNIX_SEM_UP_N         ( 0x6B | YALNIX_PREFIX)
+#define YALNIX_SEM_DOWN_N       ( 0x6C | YALNIX_PREFIX)
+#define YALNIX_SEM_TRY_DOWN     ( 0x6D | YALNIX_PREFIX)
+#define YALNIX_LOCK_TRY_ACQUIRE ( 0x6E | YALNIX_PREFIX)
+#define YALNIX_LOCK_ACQUIRE_TIMEOUT ( 0x6F | YALNIX_PREFIX)
 
 #define YALNIX_CUSTOM_0         ( 0x70 | YALNIX_PREFIX)
 #define YALNIX_CUSTOM_1         ( 0x71 | YALNIX_PREFIX)
 #define YALNIX_CUSTOM_2         ( 0x72 | YALNIX_PREFIX)
 
+#define YALNIX_SHM_INIT         ( 0x80 | YALNIX_PREFIX)
+#define YALNIX_SHM_ATTACH       ( 0x81 | YALNIX_PREFIX)
+#define YALNIX_SHM_DETACH       ( 0x82 | YALNIX_PREFIX)
+#define YALNIX_FUTEX_WAIT       ( 0x83 | YALNIX_PREFIX)
+#define YALNIX_FUTEX_WAKE       ( 0x84 | YALNIX_PREFIX)
+#define YALNIX_POLL             ( 0x85 | YALNIX_PREFIX)
+#define YALNIX_RING_SETUP       ( 0x86 | YALNIX_PREFIX)
+#define YALNIX_RING_ENTER       ( 0x87 | YALNIX_PREFIX)
+#define YALNIX_PIPE_READV       ( 0x88 | YALNIX_PREFIX)
+#define YALNIX_PIPE_WRITEV      ( 0x89 | YALNIX_PREFIX)
+#define YALNIX_TTY_WRITEV       ( 0x8A | YALNIX_PREFIX)
+#define YALNIX_PIPE_LOWAT       ( 0x8B | YALNIX_PREFIX)
+#define YALNIX_BCAST_INIT       ( 0x8C | YALNIX_PREFIX)
+#define YALNIX_BCAST_SUBSCRIBE  ( 0x8D | YALNIX_PREFIX)
+#define YALNIX_BCAST_UNSUBSCRIBE ( 0x8E | YALNIX_PREFIX)
+#define YALNIX_BCAST_WRITE      ( 0x8F | YALNIX_PREFIX)
+#define YALNIX_BCAST_READ       ( 0x90 | YALNIX_PREFIX)
+#define YALNIX_BCAST_LOST       ( 0x91 | YALNIX_PREFIX)
+#define YALNIX_MSGQ_INIT        ( 0x92 | YALNIX_PREFIX)
+#define YALNIX_MSGQ_SEND        ( 0x93 | YALNIX_PREFIX)
+#define YALNIX_MSGQ_RECEIVE     ( 0x94 | YALNIX_PREFIX)
+#define YALNIX_SPLICE           ( 0x95 | YALNIX_PREFIX)
+#define YALNIX_TEE              ( 0x96 | YALNIX_PREFIX)
+#define YALNIX_LOCK_STATS       ( 0x97 | YALNIX_PREFIX)
+#define YALNIX_RWLOCK_INIT      ( 0x98 | YALNIX_PREFIX)
+#define YALNIX_RWLOCK_READ      ( 0x99 | YALNIX_PREFIX)
+#define YALNIX_RWLOCK_WRITE     ( 0x9A | YALNIX_PREFIX)
+#define YALNIX_RWLOCK_RELEASE   ( 0x9B | YALNIX_PREFIX)
+#define YALNIX_BARRIER_INIT     ( 0x9C | YALNIX_PREFIX)
+#define YALNIX_BARRIER_WAIT     ( 0x9D | YALNIX_PREFIX)
+#define YALNIX_CVAR_WAIT_TIMEOUT ( 0x9E | YALNIX_PREFIX)
+#define YALNIX_PIPE_READ_TIMEOUT ( 0x9F | YALNIX_PREFIX)
+#define YALNIX_TTY_SET_MODE     ( 0xA0 | YALNIX_PREFIX)
+#define YALNIX_TTY_WRITE_STATS  ( 0xA1 | YALNIX_PREFIX)
+#define YALNIX_TTY_READ_TIMEOUT ( 0xA2 | YALNIX_PREFIX)
+#define YALNIX_EXEC_CACHE_STATS ( 0xA3 | YALNIX_PREFIX)
+#define YALNIX_SPAWN            ( 0xA4 | YALNIX_PREFIX)
+#define YALNIX_THREAD_CREATE    ( 0xA5 | YALNIX_PREFIX)
+#define YALNIX_THREAD_EXIT      ( 0xA6 | YALNIX_PREFIX)
+#define YALNIX_THREAD_JOIN      ( 0xA7 | YALNIX_PREFIX)
+#define YALNIX_WAIT_PID         ( 0xA8 | YALNIX_PREFIX)
+
 #define YALNIX_ABORT            ( 0xF0 | YALNIX_PREFIX)
 #define YALNIX_BOOT             ( 0xFF | YALNIX_PREFIX)
 
 #define PIPE_BUFFER_LEN         256
 
+/*
+ * Constants and structures passed across the kernel call interface, shared
+ * by the kernel and user code. See yuser.h for the calls that use them.
+ */
+
+// returned by the non-blocking variants of blocking calls when they would have blocked
+#define WOULD_BLOCK (-3)
+// returned by the timed variants of blocking calls when the time ran out
+#define TIMED_OUT (-4)
+
+// BarrierWait's return to the last arrival
+#define BARRIER_SERIAL 1
+
+// Splice and Tee target that undoes either
+#define SPLICE_NONE (-1)
+
+// TtySetMode modes
+#define TTY_COOKED 0
+#define TTY_RAW    1
+
+// WaitPid's pid for any child, and its don't-block flag
+#define WAIT_ANY    (-1)
+#define WAIT_NOHANG 1
+
+// BcastInit's policies for a subscriber a full buffer behind
+#define BCAST_BLOCK 0
+#define BCAST_DROP  1
+
+// filled in by LockStats
+typedef struct lock_stats {
+    int acquires;       // times the lock was taken
+    int contended;      // acquisitions that had to wait
+    int handoffs;       // releases that passed the lock to a waiter
+    int timeouts;       // AcquireTimeout calls that gave up
+    int read_acquires;      // reader-writer locks only: acquires that were reads
+    int read_waits;         // reads that had to wait
+    int read_wait_ticks;    // clock ticks readers spent waiting
+    int write_waits;        // writes that had to wait
+    int write_wait_ticks;   // clock ticks writers spent waiting
+} lock_stats_t;
+
+// filled in by TtyWriteStats
+typedef struct tty_write_stats {
+    int bytes;          // bytes queued for output
+    int waits;          // times a write waited for its turn or for room
+    int wait_ticks;     // clock ticks spent waiting
+} tty_write_stats_t;
+
+// filled in by ExecCacheStats
+typedef struct exec_cache_stats {
+    int hits;           // Execs served from the cache
+    int misses;         // Execs that read the file
+    int evictions;      // images dropped to make room
+    int entries;        // images cached now
+    int pages;          // pages of text and data cached now
+} exec_cache_stats_t;
+
+// one segment of a vectored read or write
+typedef struct io_vec {
+    void *base;
+    int len;
+} io_vec_t;
+
+// Poll event masks
+#define POLL_PIPE_READ      0x01    // pipe has bytes to read
+#define POLL_PIPE_WRITE     0x02    // pipe has room to write
+#define POLL_TTY_READ       0x04    // terminal has input
+#define POLL_TTY_WRITE      0x08    // terminal has no output pending
+#define POLL_CHILD_EXIT     0x10    // a child has exited and can be Waited on
+#define POLL_INVALID        0x20    // revents only: id doesn't name a live object
+
+typedef struct poll_entry {
+    int id;
+    int events;
+    int revents;
+} poll_entry_t;
+
+// submission ring page, set up by RingSetup
+#define RING_ENTRIES 64
+
+#define RING_OP_NOP             0
+#define RING_OP_TTY_WRITE       1   // id = terminal
+#define RING_OP_PIPE_READ       2   // id = pipe
+#define RING_OP_PIPE_WRITE      3   // id = pipe
+#define RING_OP_ACQUIRE         4   // id = lock
+#define RING_OP_RELEASE         5   // id = lock
+#define RING_OP_CVAR_SIGNAL     6   // id = cvar
+#define RING_OP_CVAR_BROADCAST  7   // id = cvar
+#define RING_OP_SEM_UP          8   // id = semaphore, len = count
+#define RING_OP_SEM_DOWN        9   // id = semaphore, len = count
+
+typedef struct ring_sqe {
+    int op;
+    int id;
+    void *buf;
+    int len;
+    int user_data;          // copied to the matching cq entry
+} ring_sqe_t;
+
+typedef struct ring_cqe {
+    int user_data;
+    int result;             // what the equivalent syscall would have returned
+} ring_cqe_t;
+
+typedef struct ring {
+    volatile unsigned int sq_head;  // advanced by the kernel
+    volatile unsigned int sq_tail;  // advanced by the process
+    volatile unsigned int cq_head;  // advanced by the process
+    volatile unsigned int cq_tail;  // advanced by the kernel
+    ring_sqe_t sq[RING_ENTRIES];
+    ring_cqe_t cq[RING_ENTRIES];
+} ring_t;
+
 
 
 extern void *_kernel_data_start;
@@ -2,6 +2,7 @@
 #define _YUSER_H_
 
 #include <ylib.h>
+#include <yalnix.h>
 
 // syscall wrappers
 
@@ -34,6 +35,18 @@ extern int PipeWrite (int, void *, int);
 extern int SemInit (int *, int);
 extern int SemUp (int);
 extern int SemDown (int);
+extern int SemUpN (int, int);
+extern int SemDownN (int, int);
+extern int SemTryDown (int);
+
+/*
+ * Barriers: each of the parties given to BarrierInit calls BarrierWait and
+ * blocks until the last one arrives, then all of them go on together. The
+ * barrier resets itself for the next round. The last arrival gets
+ * BARRIER_SERIAL back, the others 0.
+ */
+extern int BarrierInit (int *, int);
+extern int BarrierWait (int);
 extern int LockInit (int *);
 extern int Acquire (int);
 extern int Release (int);
@@ -42,8 +55,186 @@ extern int CvarWait (int, int);
 extern int CvarSignal (int);
 extern int CvarBroadcast (int);
 
+/*
+ * Timed waits return TIMED_OUT once the given clock ticks pass. A
+ * CvarWaitTimeout that times out still returns holding the lock. A
+ * PipeReadTimeout only times out on an empty pipe; bytes short of the
+ * pipe's low watermark are returned once the time is up.
+ */
+extern int CvarWaitTimeout (int, int, int);
+extern int PipeReadTimeout (int, void *, int, int);
+
 extern int Reclaim (int);
 
+extern int ShmInit (int *, int);
+extern int ShmAttach (int, void **);
+extern int ShmDetach (void *);
+
+extern int FutexWait (int *, int);
+extern int FutexWake (int *, int);
+
+/*
+ * Locks are handed straight from Release to the oldest waiter, so they're
+ * acquired in FIFO order. TryAcquire returns WOULD_BLOCK instead of
+ * waiting; AcquireTimeout returns TIMED_OUT after the given ticks.
+ * LockStats copies out a lock's counters.
+ */
+extern int TryAcquire (int);
+extern int AcquireTimeout (int, int);
+extern int LockStats (int, lock_stats_t *);
+
+/*
+ * Reader-writer locks share ids, Reclaim and LockStats with locks. Any
+ * number of readers hold one together; writers hold it alone. Writers are
+ * preferred: once a writer is waiting, new readers wait behind it, and a
+ * releasing writer hands the lock to the next writer before any readers.
+ */
+extern int RWLockInit (int *);
+extern int RWLockRead (int);
+extern int RWLockWrite (int);
+extern int RWLockRelease (int);
+
+/*
+ * PipeSetLowat: readers of the pipe stay blocked until it holds min_bytes
+ * (or all they asked for, if less), batching small writes into fewer reads.
+ * If ticks > 0, a reader that has waited that long takes whatever is there.
+ */
+extern int PipeSetLowat (int, int, int);
+
+/*
+ * Splice(pipe, dest): the kernel moves everything written to pipe on to
+ * dest, a terminal number or another pipe, as it arrives. Tee(pipe, copy):
+ * every byte written to pipe also goes into copy. SPLICE_NONE undoes either.
+ */
+extern int Splice (int, int);
+extern int Tee (int, int);
+
+/*
+ * Vectored I/O: one call moves a list of (base, len) segments as a single
+ * read or write, with no staging copy in user space. At most 16 segments.
+ */
+extern int PipeReadv (int, io_vec_t *, int);
+extern int PipeWritev (int, io_vec_t *, int);
+extern int TtyWritev (int, io_vec_t *, int);
+
+/*
+ * TtySetMode(tty, mode, capacity): a TTY_COOKED terminal returns at most one
+ * line per TtyRead, a TTY_RAW one returns whatever input is buffered, up to
+ * the length asked for. Input beyond the terminal's capacity in bytes is
+ * dropped; capacity 0 keeps the current one.
+ */
+extern int TtySetMode (int, int, int);
+
+/*
+ * TtyReadTimeout(tty, buf, len, ticks) reads like TtyRead but gives up with
+ * TIMED_OUT after ticks clock ticks without input. With ticks 0 it never
+ * waits and returns 0 when no line is buffered.
+ */
+extern int TtyReadTimeout (int, void *, int, int);
+
+/*
+ * Exec keeps recently run programs in a kernel cache, so running one again
+ * skips reading its file. ExecCacheStats copies out the cache's counters.
+ */
+extern int ExecCacheStats (exec_cache_stats_t *);
+
+/*
+ * Spawn(path, argv) starts a child running path with argv, like Fork then
+ * Exec in the child, without copying the caller's memory. It returns the
+ * child's pid, or ERROR (and no child) if the program can't be loaded.
+ */
+extern int Spawn (char *, char **);
+
+/*
+ * ThreadCreate(func, arg) starts a thread running func(arg) in the caller's
+ * address space, with its own small stack, and returns its id. The thread
+ * ends when func returns or calls ThreadExit (Exit in a thread does the
+ * same), and ThreadJoin(id, &status) waits for it and gets the exit code.
+ * Threads share memory, so guard shared data with the lock and cvar calls.
+ * Exec fails while a process has threads, and always fails in a thread.
+ * Exiting a process ends its threads. malloc isn't thread safe.
+ */
+extern int ThreadCreate (int (*)(void *), void *);
+extern void ThreadExit (int);
+extern int ThreadJoin (int, int *);
+
+/*
+ * WaitPid(pid, &status, flags) waits for child pid, or any child with
+ * WAIT_ANY, and returns its pid with its exit code in status (status may
+ * be NULL). With WAIT_NOHANG it returns WOULD_BLOCK at once if that child
+ * hasn't exited yet. ERROR if pid isn't a child of the caller. Wait(&status)
+ * is WaitPid(WAIT_ANY, &status, 0).
+ */
+extern int WaitPid (int, int *, int);
+
+/*
+ * Writers to one terminal take turns a line at a time (or TERMINAL_MAX_LINE
+ * bytes of a longer line), so a long write can't hold the terminal up.
+ * Each write's bytes stay in order and lines are never split between
+ * writers. TtyWriteStats copies out the caller's counters for a terminal.
+ */
+extern int TtyWriteStats (int, tty_write_stats_t *);
+
+/*
+ * Broadcast channels: BcastWrite copies the bytes into the channel once and
+ * every subscribed process reads them with BcastRead. A subscription starts
+ * at the next byte written. When a subscriber falls a full buffer behind,
+ * BCAST_BLOCK makes the writer wait and BCAST_DROP overwrites the unread
+ * bytes; BcastLost returns (and clears) how many bytes the caller missed.
+ */
+extern int BcastInit (int *, int);
+extern int BcastSubscribe (int);
+extern int BcastUnsubscribe (int);
+extern int BcastWrite (int, void *, int);
+extern int BcastRead (int, void *, int);
+extern int BcastLost (int);
+
+/*
+ * Message queues: MsgqSend leaves a whole message (of any length up to the
+ * queue's byte bound) in the kernel and returns, blocking only while the
+ * queue is too full for it. MsgqReceive takes the highest priority message,
+ * oldest first within a priority, and returns its length; it fails without
+ * dequeuing if the buffer is too small. Reclaim frees the queue.
+ */
+extern int MsgqInit (int *, int);
+extern int MsgqSend (int, void *, int, int);
+extern int MsgqReceive (int, void *, int, int *);
+
+/*
+ * Poll: wait for any of several objects to become ready. events and revents
+ * are POLL_* masks; id is a pipe id or terminal number, and is ignored for
+ * POLL_CHILD_EXIT. The timeout is in clock ticks, 0 to only check and -1 to
+ * wait forever. Poll returns the number of ready entries, 0 on timeout.
+ */
+extern int Poll (poll_entry_t *, int, int);
+
+/*
+ * Submission ring: a page shared with the kernel, holding a queue of
+ * operations (sq) and a queue of their results (cq). The process fills sq
+ * entries and bumps sq_tail, then one RingEnter runs them all in order and
+ * posts a cq entry per operation, instead of one trap per operation.
+ * Head and tail only ever grow; slots are used modulo RING_ENTRIES.
+ */
+extern int RingSetup (ring_t **);
+extern int RingEnter (int);
+
+extern int RingPush (ring_t *, int, int, void *, int, int);
+extern int RingSubmit (ring_t *);
+extern int RingPop (ring_t *, ring_cqe_t *);
+
+/*
+ * User-space lock built on the futex calls: Acquire and Release stay in
+ * user space unless the lock is contended. To share one between processes
+ * put it in a shared memory segment.
+ */
+typedef struct ulock {
+    volatile int state;     // 0 free, 1 held, 2 held with (possible) waiters
+} ulock_t;
+
+extern int ULockInit (ulock_t *);
+extern int ULockAcquire (ulock_t *);
+extern int ULockRelease (ulock_t *);
+
 extern int Custom0 (int,int,int,int);
 extern int Custom1 (int,int,int,int);
 extern int Custom2 (int,int,int,int);
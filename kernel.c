@@ -19,6 +19,8 @@
 #include "include.h"
 #include "traphandlers.h"
 #include "process.h"
+#include "tty.h"
+#include "image.h"
 
 
 
@@ -28,22 +30,39 @@ pcb_t *activePCB;
 int num_of_frames;
 queue_t *ready_q;
 queue_t *blocked_q;
-queue_t *defunct_q;
+queue_t *thread_done_q;
 list_t *pfn_list;
+int *pfn_refcount;
 int global_clock_ticks;
 pcb_t *idlePCB;
 queue_t *ttyReadQueues[NUM_TERMINALS];
 queue_t *ttyWriteQueues[NUM_TERMINALS];
-char *ttyReadbuffers[NUM_TERMINALS];
 int ttyWriteTrackers[NUM_TERMINALS];
-int ttyReadTrackers[NUM_TERMINALS];
+int ttySplicePipes[NUM_TERMINALS];
 pipe_t *head_pipe;
 list_t *lock_list;
 list_t *cvar_list;
 int lock_status[MAX_LOCKS];
 int cvar_status[MAX_CVARS];
 queue_t *lockAquireQueues[MAX_LOCKS];
+lock_stats_t lock_stats[MAX_LOCKS];
+int lock_type[MAX_LOCKS];
+int lock_readers[MAX_LOCKS];
+queue_t *rwReadQueues[MAX_LOCKS];
+queue_t *rwReadHolders[MAX_LOCKS];
 queue_t *cvarWaitQueues[MAX_CVARS];
+list_t *sem_list;
+int sem_status[MAX_SEMS];
+int sem_value[MAX_SEMS];
+queue_t *semWaitQueues[MAX_SEMS];
+list_t *barrier_list;
+int barrier_parties[MAX_BARRIERS];
+int barrier_arrived[MAX_BARRIERS];
+queue_t *barrierWaitQueues[MAX_BARRIERS];
+queue_t *futexQueues[FUTEX_BUCKETS];
+queue_t *poll_q;
+list_t *process_list;
+int service_registry[MAX_SERVICES];
 
 int id_tracker;
 
@@ -205,22 +224,40 @@ int SetUpGlobals() {
     // global queues for processes
     ready_q = queue_init();
     blocked_q = queue_init();
-    defunct_q = queue_init();
+    thread_done_q = queue_init();
 
     // linked list of free page frames
     pfn_list = list_init();
 
+    // share counts for frames mapped by more than one process
+    pfn_refcount = malloc(sizeof(int) * num_of_frames);
+    if (pfn_refcount == NULL) {
+        TracePrintf(0, "ERROR: SetUpGlobals, malloc for pfn_refcount failed\n");
+        return ERROR;
+    }
+    memset(pfn_refcount, 0, sizeof(int) * num_of_frames);
+
     // global queues for processes reading/writing to terminal
 
     lock_list = list_init();
     cvar_list = list_init();
+    sem_list = list_init();
+    barrier_list = list_init();
+
+    // table of live processes and registered services for message passing
+    process_list = list_init();
+    for (int i = 0; i < MAX_SERVICES; i++) {
+        service_registry[i] = NO_SERVICE;
+    }
     for (int i = 0; i < NUM_TERMINALS; i++) {
         ttyReadQueues[i] = queue_init();
         ttyWriteQueues[i] = queue_init();
-        ttyReadbuffers[i] = malloc(TERMINAL_MAX_LINE * sizeof(char));
         ttyWriteTrackers[i] = TERMINAL_OPEN;
-        ttyReadTrackers[i] = 0;
-        memset(ttyReadbuffers[i], 0, TERMINAL_MAX_LINE);
+        ttySplicePipes[i] = NO_SPLICE;
+    }
+    if (tty_init() == ERROR) {
+        TracePrintf(0, "ERROR: SetUpGlobals, terminal input buffers failed\n");
+        return ERROR;
     }
 
     // error checking global queues
@@ -228,6 +265,11 @@ int SetUpGlobals() {
     for (int i = 0; i < MAX_LOCKS; i++) {
         lockAquireQueues[i] = queue_init();
         lock_status[i] = UNUSED_LOCK;
+        memset(&lock_stats[i], 0, sizeof(lock_stats_t));
+        rwReadQueues[i] = queue_init();
+        rwReadHolders[i] = queue_init();
+        lock_type[i] = MUTEX_LOCK;
+        lock_readers[i] = 0;
         if (list_add(lock_list, (void *) i) == ERROR) {
             TracePrintf(0, "ERROR: SetUpGlobals, adding to list failed");
             return ERROR;
@@ -238,12 +280,38 @@ int SetUpGlobals() {
         cvarWaitQueues[i] = queue_init();
         cvar_status[i] = UNUSED_CVAR;
         //TracePrintf(1, "adding to cvar list with %d\n", (MAX_LOCKS + i));
-        list_add(cvar_list, (void *) MAX_LOCKS + i + 1);
+        list_add(cvar_list, (void *) (MAX_LOCKS + i + 1));
     }
 
+    poll_q = queue_init();
 
+    for (int i = 0; i < FUTEX_BUCKETS; i++) {
+        futexQueues[i] = queue_init();
+    }
+
+    for (int i = 0; i < MAX_SEMS; i++) {
+        semWaitQueues[i] = queue_init();
+        sem_status[i] = UNUSED_SEM;
+        sem_value[i] = 0;
+        if (list_add(sem_list, (void *) (SEM_ID_BASE + i)) == ERROR) {
+            TracePrintf(0, "ERROR: SetUpGlobals, adding to sem list failed");
+            return ERROR;
+        }
+    }
 
-    if (ready_q == NULL || blocked_q == NULL || defunct_q == NULL || pfn_list == NULL) {
+    for (int i = 0; i < MAX_BARRIERS; i++) {
+        barrierWaitQueues[i] = queue_init();
+        barrier_parties[i] = 0;
+        barrier_arrived[i] = 0;
+        if (list_add(barrier_list, (void *) (BARRIER_ID_BASE + i)) == ERROR) {
+            TracePrintf(0, "ERROR: SetUpGlobals, adding to barrier list failed");
+            return ERROR;
+        }
+    }
+
+
+
+    if (ready_q == NULL || blocked_q == NULL || thread_done_q == NULL || pfn_list == NULL || process_list == NULL) {
         TracePrintf(0, "ERROR: SetUpGlobals, initalization of queues failed\n");
         return ERROR;
     }
@@ -520,11 +588,18 @@ int AllocatePFN() {
 }
 
 /**
- * @brief 
+ * @brief drops a reference to pfn, the frame only goes back on the free
+ * list once its last holder lets go of it
  * 
  * @param pfn 
  */
 int DeallocatePFN(int pfn) {
+    if (pfn_refcount[pfn] > 1) {
+        pfn_refcount[pfn]--;
+        TracePrintf(0, "Dropping shared PFN -> %d (%d holders left)\n", pfn, pfn_refcount[pfn]);
+        return 0;
+    }
+    pfn_refcount[pfn] = 0;
     TracePrintf(0, "Dellocating PFN -> %d\n", pfn);
     if (list_add(pfn_list, (void *) pfn) == -1) {
         TracePrintf(0,"DeallocatePFN has failed\n");
@@ -535,34 +610,16 @@ int DeallocatePFN(int pfn) {
 }
 
 /**
- * @brief 
+ * @brief malloc that drops cached Exec images to make room before giving up.
+ * SetKernelBrk can't evict them itself, it runs inside malloc.
  * 
- * @param pcb 
- * @return queue_t* 
+ * @param size 
+ * @return void* NULL if even an empty image cache leaves no room
  */
-queue_t *CheckBlocked(pcb_t *pcb) {
-
-    if (pcb == NULL) return NULL;
-
-    switch (pcb->blocked_code) {
-    case BLOCKED_DELAY:
-        if (pcb->clock_ticks > 0) {
-            pcb->clock_ticks--;
-        } else {
-            pcb->blocked_code = NOT_BLOCKED;
-            return ready_q;
-        }
-        break;
-    case BLOCKED_TTY_TRANSMIT:
-        if (ttyWriteTrackers[pcb->tty_terminal] == TERMINAL_OPEN) {
-            pcb->blocked_code = NOT_BLOCKED;
-            pcb->tty_terminal = 0;
-            return ready_q;
-        }
-        return NULL;
-    default:
-        break;
+void *ReclaimingMalloc(size_t size) {
+    void *p = malloc(size);
+    while (p == NULL && image_evict()) {
+        p = malloc(size);
     }
-
-    return blocked_q;
+    return p;
 }
@@ -10,6 +10,7 @@
 #define __KERNEL_H_
 
 #include <hardware.h>
+#include <yalnix.h>
 #include "pipe.h"
 #include "queue.h"
 #include "process.h"
@@ -109,19 +110,20 @@ int AllocatePFN();
 int DeallocatePFN(int pfn);
 
 /**
- * @brief 
+ * @brief malloc that drops cached Exec images to make room before giving up
  * 
- * @param uctxt 
+ * @param size 
+ * @return void* NULL if even an empty image cache leaves no room
  */
-int SwapProcess(queue_t *moveActive,UserContext *uctxt);
+void *ReclaimingMalloc(size_t size);
 
 /**
  * @brief 
  * 
- * @param pcb 
- * @return queue_t* 
+ * @param uctxt 
  */
-queue_t *CheckBlocked(pcb_t *pcb);
+int SwapProcess(queue_t *moveActive,UserContext *uctxt);
+
 
 
     
@@ -143,6 +145,28 @@ extern void *kernel_brk;
 
 #define MAX_LOCKS 100
 #define MAX_CVARS 5000
+#define MAX_SERVICES 32
+#define MAX_SHM_SEGMENTS 32
+#define MAX_SEMS 100
+#define MAX_BCASTS 16
+#define MAX_MSGQS 16
+#define MAX_BARRIERS 32
+#define FUTEX_BUCKETS 64
+#define MAX_POLL_ENTRIES 32
+#define MAX_IOV 16
+
+// ids handed out by Reclaim-able objects: locks, then cvars, then the ranges below, then pipes
+#define SHM_ID_BASE (MAX_LOCKS + MAX_CVARS + 1)
+#define SEM_ID_BASE (SHM_ID_BASE + MAX_SHM_SEGMENTS)
+#define BCAST_ID_BASE (SEM_ID_BASE + MAX_SEMS)
+#define MSGQ_ID_BASE (BCAST_ID_BASE + MAX_BCASTS)
+#define BARRIER_ID_BASE (MSGQ_ID_BASE + MAX_MSGQS)
+#define PIPE_ID_BASE (BARRIER_ID_BASE + MAX_BARRIERS)
+
+// pages left free below the user stack when placing shared memory
+#define SHM_STACK_GAP 8
+// pages of stack a thread gets, above an unmapped guard page
+#define THREAD_STACK_PAGES 4
 
 // tracefile that traceprint writes to
 extern char* tracefile; //= TRACE;
@@ -151,18 +175,21 @@ extern pcb_t *activePCB;
 // global queues
 extern queue_t *ready_q;
 extern queue_t *blocked_q;
-extern queue_t *defunct_q;
+// exited threads waiting for ThreadJoin
+extern queue_t *thread_done_q;
 // keeping track of free page frame numbers
 extern list_t *pfn_list;
+// number of holders of each shared frame, 0 for frames owned by a single process
+extern int *pfn_refcount;
 // clock ticks
 extern int global_clock_ticks;
 extern pcb_t *idlePCB;
 // terminal helpers
 extern queue_t *ttyReadQueues[NUM_TERMINALS];
 extern queue_t *ttyWriteQueues[NUM_TERMINALS];
-extern char *ttyReadbuffers[NUM_TERMINALS];
 extern int ttyWriteTrackers[NUM_TERMINALS];
-extern int ttyReadTrackers[NUM_TERMINALS];
+// pipe spliced to each terminal, NO_SPLICE if none
+extern int ttySplicePipes[NUM_TERMINALS];
 // parent pipe, the pipe with id 0
 extern pipe_t *head_pipe;
 // locks and cvars
@@ -171,7 +198,33 @@ extern int lock_status[MAX_LOCKS];
 extern list_t *cvar_list;
 extern int cvar_status[MAX_CVARS];
 extern queue_t *lockAquireQueues[MAX_LOCKS];
+extern lock_stats_t lock_stats[MAX_LOCKS];
+// MUTEX_LOCK or RW_LOCK; reader-writer locks also count their readers and
+// queue readers apart from writers, who wait in lockAquireQueues
+extern int lock_type[MAX_LOCKS];
+extern int lock_readers[MAX_LOCKS];
+extern queue_t *rwReadQueues[MAX_LOCKS];
+// processes holding each reader-writer lock for reading, one entry per hold
+extern queue_t *rwReadHolders[MAX_LOCKS];
 extern queue_t *cvarWaitQueues[MAX_CVARS];
+// semaphores, indexed by id - SEM_ID_BASE
+extern list_t *sem_list;
+extern int sem_status[MAX_SEMS];
+extern int sem_value[MAX_SEMS];
+extern queue_t *semWaitQueues[MAX_SEMS];
+// barriers, indexed by id - BARRIER_ID_BASE; 0 parties means unused
+extern list_t *barrier_list;
+extern int barrier_parties[MAX_BARRIERS];
+extern int barrier_arrived[MAX_BARRIERS];
+extern queue_t *barrierWaitQueues[MAX_BARRIERS];
+// processes in FutexWait, hashed by the physical address they wait on
+extern queue_t *futexQueues[FUTEX_BUCKETS];
+// processes blocked in Poll
+extern queue_t *poll_q;
+// every live process, for lookups by pid
+extern list_t *process_list;
+// pid registered for each service id, NO_SERVICE if none
+extern int service_registry[MAX_SERVICES];
 
 
 // tick interval of clock
@@ -17,6 +17,7 @@ list_t *list_init() {
     list->head = NULL;
     list->tail = NULL;
     list->size = 0;
+    return list;
 }
 
 int list_add(list_t *list, void *item) {
@@ -61,6 +62,30 @@ void list_iter(list_t *list, void *arg, void (*iter) (void *arg, void *item)) {
     }
 }
 
+/**
+ * @brief removes the first node holding item from the list
+ * 
+ * @param list 
+ * @param item item to remove
+ * @param check optional function called on the removed item
+ * @return int 0 if removed, ERROR if not found
+ */
+int list_remove(list_t *list, void *item, void (*check)(void *arg)) {
+    if (list == NULL) return ERROR;
+    for (lnode_t *node = list->head; node != NULL; node = node->next) {
+        if (node->data == item) {
+            if (node->prev == NULL) list->head = node->next;
+            else node->prev->next = node->next;
+            if (node->next == NULL) list->tail = node->prev;
+            else node->next->prev = node->prev;
+            list->size--;
+            lnode_delete(node, check);
+            return 0;
+        }
+    }
+    return ERROR;
+}
+
 static lnode_t *lnode_init(void *item) {
     lnode_t *node = malloc(sizeof(lnode_t));
     if (node == NULL) return NULL;
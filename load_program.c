@@ -9,6 +9,7 @@
 #include "kernel.h"
 #include "include.h"
 #include "process.h"
+#include "image.h"
 
 
 /*
@@ -18,7 +19,7 @@
 int LoadProgram(char *name, char *args[], pcb_t *proc)
 
 {
-  int fd;
+  image_t *img;
   int (*entry)();
   struct load_info li;
   int i;
@@ -35,27 +36,15 @@ int LoadProgram(char *name, char *args[], pcb_t *proc)
   char *argbuf;
 
   /*
-   * Open the executable file
+   * Get the executable, parsed and read in, from the image cache. It only
+   * touches the file if the program isn't cached or the file has changed.
    */
-  if ((fd = open(name, O_RDONLY)) < 0)
+  if ((img = image_get(name)) == NULL)
   {
-    TracePrintf(0, "LoadProgram: can't open file '%s'\n", name);
-    return ERROR;
-  }
-
-  if (LoadInfo(fd, &li) != LI_NO_ERROR)
-  {
-    TracePrintf(0, "LoadProgram: '%s' not in Yalnix format\n", name);
-    close(fd);
-    return (-1);
-  }
-
-  if (li.entry < VMEM_1_BASE)
-  {
-    TracePrintf(0, "LoadProgram: '%s' not linked for Yalnix\n", name);
-    close(fd);
+    TracePrintf(0, "LoadProgram: can't load '%s'\n", name);
     return ERROR;
   }
+  li = img->li;
 
   /*
    * Figure out in what region 1 page the different program sections
@@ -117,7 +106,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc)
 
   /* leave at least one page between heap and stack */
   if (stack_npg + data_pg1 + data_npg >= MAX_PT_LEN) {
-    close(fd);
+    image_put(img);
     return ERROR;
   }
 
@@ -140,7 +129,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc)
    * Now save the arguments in a separate buffer in region 0, since
    * we are about to blow away all of region 1.
    */
-  cp2 = argbuf = (char *)malloc(size);
+  cp2 = argbuf = (char *)ReclaimingMalloc(size);
 
   /* DONE
    * ==>> You should perhaps check that malloc returned valid space
@@ -149,6 +138,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc)
   if (cp2 == NULL)
   {
     TracePrintf(0, "ERROR: Malloc for cp2 and argbuf failed.\n");
+    image_put(img);
     return ERROR;
   }
 
@@ -161,113 +151,81 @@ int LoadProgram(char *name, char *args[], pcb_t *proc)
 
   /* 
    * Set up the page tables for the process so that we can read the
-   * program into memory.  Get the right number of physical pages
-   * allocated, and set them all to writable.
+   * program into memory.  The new image is built over the old one in a
+   * single pass: a page the new image needs keeps the frame already
+   * mapped there, frames left over from pages it doesn't need go to
+   * pages that had none, and only the shortfall comes from AllocatePFN.
+   * Shared frames (pfn_refcount > 0, e.g. shared memory) are never
+   * reused, just let go of. Everything is mapped writable for now.
    */
 
-  int u_pt_size = VMEM_1_SIZE / PAGESIZE;
   pte_t *u_pt = proc->user_page_table;
-  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
   WriteRegister(REG_PTBR1, (unsigned int) u_pt);
 
     if (u_pt == NULL) {
         TracePrintf(0,"ERROR, user page table is null\n");
+        free(argbuf);
+        image_put(img);
         return ERROR;
     }
 
-  // vp0 = virtual page number 0 of region1
-  int vp0 = VMEM_1_BASE >> PAGESHIFT;
-  // pf0 = physical frame number 0
-  int pf0 = PMEM_BASE >> PAGESHIFT;
-
-
-  /* ==>> Throw away the old region 1 virtual address space by
-   * ==>> curent process by walking through the R1 page table and,
-   * ==>> for every valid page, free the pfn and mark the page invalid.
-   */
-
-  for (int i = 0; i < u_pt_size; i++) {
-    if (u_pt[i].valid == VALID_FRAME) {
+  int stack_pg1 = MAX_PT_LEN - stack_npg;
+  int spare[MAX_PT_LEN];      // frames freed up by pages the image doesn't use
+  int spare_n = 0;
+  int need[MAX_PT_LEN];       // pages the image uses that have no frame yet
+  int need_n = 0;
+
+  proc->user_text_pt_index = text_pg1;
+  proc->user_data_pt_index = data_pg1;
+  proc->user_heap_pt_index = data_pg1 + data_npg;
+  proc->user_stack_pt_index = stack_pg1;
+
+  for (int i = 0; i < MAX_PT_LEN; i++) {
+      int used = (i >= text_pg1 && i < text_pg1 + li.t_npg) ||
+                 (i >= data_pg1 && i < data_pg1 + data_npg) ||
+                 i >= stack_pg1;
+      int mine = u_pt[i].valid == VALID_FRAME && pfn_refcount[u_pt[i].pfn] == 0;
+
+      if (u_pt[i].valid == VALID_FRAME && !mine) {
+          DeallocatePFN(u_pt[i].pfn);
+      }
+      if (mine && used) {
+          u_pt[i].prot = NO_X_W_R;
+          continue;
+      }
+      if (mine) {
+          spare[spare_n++] = u_pt[i].pfn;
+      }
+      if (used) {
+          need[need_n++] = i;
+      }
       u_pt[i].valid = INVALID_FRAME;
-      int pfn = u_pt[i].pfn;
-      DeallocatePFN(pfn);
       u_pt[i].pfn = 0;
-      TracePrintf(0, "Freed pfn ->%d\n", pfn);
-    }
   }
 
-  /*
-   * ==>> Then, build up the new region1.
-   * ==>> (See the LoadProgram diagram in the manual.)
-   */
-
-    /*
-    * ==>> First, text. Allocate "li.t_npg" physical pages and map them starting at
-    * ==>> the "text_pg1" page in region 1 address space.
-    * ==>> These pages should be marked valid, with a protection of
-    * ==>> (PROT_READ | PROT_WRITE).
-    */
-
-   proc->user_text_pt_index = text_pg1;
-
-    for (int i = text_pg1; i < text_pg1 + li.t_npg; i++) {
-        u_pt[i].valid = VALID_FRAME;
-        u_pt[i].prot = NO_X_W_R;
-        int pfn = AllocatePFN();
-        if (pfn == -1) {
-            TracePrintf(0, "ERROR: Invalid PFN.\n");
-            free_addr_space(proc->user_page_table, proc->kernel_stack_pt);
-            return ERROR;
-        }
-        if (pfn == -1) return ERROR;
-        u_pt[i].pfn = pfn;
-    }
-
-   /*
-    * ==>> Then, data. Allocate "data_npg" physical pages and map them starting at
-    * ==>> the  "data_pg1" in region 1 address space.
-    * ==>> These pages should be marked valid, with a protection of
-    * ==>> (PROT_READ | PROT_WRITE).z
-    */
-
-    proc->user_data_pt_index = data_pg1;
-
-    for (int i = data_pg1; i < data_pg1 + data_npg; i++) {
-        u_pt[i].valid = VALID_FRAME;
-        u_pt[i].prot = NO_X_W_R;
-        int pfn = AllocatePFN();
-        if (pfn == -1) {
-            TracePrintf(0, "ERROR: Invalid PFN.\n");
-            free_addr_space(proc->user_page_table, proc->kernel_stack_pt);
-            return ERROR;
-        }
-        if (pfn == -1) return ERROR;
-        u_pt[i].pfn = pfn;
-    }
-
-    proc->user_heap_pt_index = data_pg1 + data_npg;
-
-    /*
-    * ==>> Then, stack. Allocate "stack_npg" physical pages and map them to the top
-    * ==>> of the region 1 virtual address space.
-    * ==>> These pages should be marked valid, with a
-    * ==>> protection of (PROT_READ | PROT_WRITE).
-    */
-
-   proc->user_stack_pt_index =  MAX_PT_LEN - stack_npg;
-
-    for (int i = MAX_PT_LEN - stack_npg; i < MAX_PT_LEN; i++) {
-        u_pt[i].valid = VALID_FRAME;
-        u_pt[i].prot = NO_X_W_R;
-        int pfn = AllocatePFN();
-        if (pfn == -1) {
-            TracePrintf(0, "ERROR: Invalid PFN.\n");
-            free_addr_space(proc->user_page_table, proc->kernel_stack_pt);
-            return ERROR;
-        }
-        if (pfn == -1) return ERROR;
-        u_pt[i].pfn = pfn;
-    }
+  TracePrintf(1, "LoadProgram: %d frames spare, %d pages short\n", spare_n, need_n);
+
+  for (int n = 0; n < need_n; n++) {
+      int pfn = spare_n > 0 ? spare[--spare_n] : AllocatePFN();
+      if (pfn == ERROR) {
+          TracePrintf(0, "ERROR: Invalid PFN.\n");
+          // give back region 1; the kernel stack goes with the process
+          for (int i = 0; i < MAX_PT_LEN; i++) {
+              if (u_pt[i].valid == VALID_FRAME) DeallocatePFN(u_pt[i].pfn);
+              u_pt[i].valid = INVALID_FRAME;
+              u_pt[i].pfn = 0;
+          }
+          free(argbuf);
+          image_put(img);
+          return ERROR;
+      }
+      u_pt[need[n]].valid = VALID_FRAME;
+      u_pt[need[n]].prot = NO_X_W_R;
+      u_pt[need[n]].pfn = pfn;
+  }
+  while (spare_n > 0) {
+      DeallocatePFN(spare[--spare_n]);
+  }
 
   /*
    * ==>> (Finally, make sure that there are no stale region1 mappings left in the TLB!)
@@ -280,29 +238,14 @@ int LoadProgram(char *name, char *args[], pcb_t *proc)
    */
 
   /*
-   * Read the text from the file into memory.
+   * Copy the text and data from the image into memory.
    */
-  lseek(fd, li.t_faddr, SEEK_SET);
   segment_size = li.t_npg << PAGESHIFT;
-  if (read(fd, (void *)li.t_vaddr, segment_size) != segment_size)
-  {
-    close(fd);
-    return KILL; // see ykernel.h
-  }
-
-  /*
-   * Read the data from the file into memory.
-   */
-  lseek(fd, li.id_faddr, 0);
+  memcpy((void *)li.t_vaddr, img->text, segment_size);
   segment_size = li.id_npg << PAGESHIFT;
+  memcpy((void *)li.id_vaddr, img->data, segment_size);
 
-  if (read(fd, (void *)li.id_vaddr, segment_size) != segment_size)
-  {
-    close(fd);
-    return KILL;
-  }
-
-  close(fd); /* we've read it all now */
+  image_put(img); /* we've copied it all now */
 
   /*
    * ==>> Above, you mapped the text pages as writable, so this code could write
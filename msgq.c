@@ -0,0 +1,126 @@
+/*
+ * msgq.c
+ *
+ * message queues, see msgq.h
+ */
+
+#include <ylib.h>
+#include "msgq.h"
+#include "kernel.h"
+#include "include.h"
+
+// queue with id MSGQ_ID_BASE + i lives at index i
+static msgq_t *msg_queues[MAX_MSGQS];
+
+/**
+ * @brief creates a message queue
+ * 
+ * @param max_bytes bound on queued bytes, 0 for the default
+ * @return int id of the queue, ERROR otherwise
+ */
+int msgq_create(int max_bytes) {
+    if (max_bytes == 0) max_bytes = MSGQ_DEFAULT_BYTES;
+    if (max_bytes < 0 || max_bytes > MSGQ_MAX_BYTES) return ERROR;
+
+    int slot = -1;
+    for (int i = 0; i < MAX_MSGQS; i++) {
+        if (msg_queues[i] == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == -1) return ERROR;
+
+    msgq_t *mq = malloc(sizeof(msgq_t));
+    if (mq == NULL) return ERROR;
+    mq->receivers = queue_init();
+    mq->senders = queue_init();
+    if (mq->receivers == NULL || mq->senders == NULL) {
+        free(mq);
+        return ERROR;
+    }
+    mq->id = MSGQ_ID_BASE + slot;
+    mq->max_bytes = max_bytes;
+    mq->bytes = 0;
+    mq->count = 0;
+    mq->head = NULL;
+    msg_queues[slot] = mq;
+    return mq->id;
+}
+
+/**
+ * @brief Get the message queue object
+ * 
+ * @param id 
+ * @return msgq_t* NULL if there's no queue with id
+ */
+msgq_t *get_msgq(int id) {
+    if (id < MSGQ_ID_BASE || id >= MSGQ_ID_BASE + MAX_MSGQS) return NULL;
+    return msg_queues[id - MSGQ_ID_BASE];
+}
+
+/**
+ * @brief copies a message into mq behind every message of the same or
+ * higher priority
+ * 
+ * @param mq 
+ * @param buf 
+ * @param len 
+ * @param prio 
+ * @return int 0 if success, ERROR if it didn't fit or malloc failed
+ */
+int msgq_put(msgq_t *mq, void *buf, int len, int prio) {
+    if (mq->bytes + len > mq->max_bytes) return ERROR;
+
+    msg_t *msg = ReclaimingMalloc(sizeof(msg_t) + len);
+    if (msg == NULL) return ERROR;
+    msg->prio = prio;
+    msg->len = len;
+    memcpy(msg->data, buf, len);
+
+    msg_t **link = &mq->head;
+    while (*link != NULL && (*link)->prio >= prio) {
+        link = &(*link)->next;
+    }
+    msg->next = *link;
+    *link = msg;
+
+    mq->bytes += len;
+    mq->count++;
+    return 0;
+}
+
+/**
+ * @brief takes the first message off mq, the caller frees it
+ * 
+ * @param mq 
+ * @return msg_t* NULL if mq is empty
+ */
+msg_t *msgq_take(msgq_t *mq) {
+    msg_t *msg = mq->head;
+    if (msg == NULL) return NULL;
+
+    mq->head = msg->next;
+    mq->bytes -= msg->len;
+    mq->count--;
+    return msg;
+}
+
+/**
+ * @brief frees the queue and any messages still in it
+ * 
+ * @param id 
+ * @return int 0 if success, ERROR if it doesn't exist or has blocked processes
+ */
+int msgq_reclaim(int id) {
+    msgq_t *mq = get_msgq(id);
+    if (mq == NULL || mq->receivers->size > 0 || mq->senders->size > 0) return ERROR;
+
+    msg_t *msg;
+    while ((msg = msgq_take(mq)) != NULL) free(msg);
+    queue_delete(mq->receivers, NULL);
+    queue_delete(mq->senders, NULL);
+    free(mq);
+    msg_queues[id - MSGQ_ID_BASE] = NULL;
+    return 0;
+}
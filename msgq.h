@@ -0,0 +1,80 @@
+#ifndef __MSGQ_H_
+#define __MSGQ_H_
+
+#include "process.h"
+#include "queue.h"
+
+/*
+ * msgq.h
+ *
+ * message queues: senders leave whole messages in the kernel and carry on,
+ * receivers take them highest priority first (oldest first within a
+ * priority). The bytes held by a queue are bounded; a sender only waits
+ * when its message doesn't fit.
+ */
+
+#define MSGQ_DEFAULT_BYTES 4096
+#define MSGQ_MAX_BYTES 65536
+
+typedef struct msg {
+    int prio;
+    int len;
+    struct msg *next;
+    char data[];
+} msg_t;
+
+typedef struct msgq {
+    int id;
+    int max_bytes;          // bound on the bytes of queued messages
+    int bytes;              // bytes of queued messages
+    int count;              // number of queued messages
+    msg_t *head;            // highest priority first
+    queue_t *receivers;     // processes waiting for a message
+    queue_t *senders;       // processes waiting for room
+} msgq_t;
+
+/**
+ * @brief creates a message queue
+ * 
+ * @param max_bytes bound on queued bytes, 0 for the default
+ * @return int id of the queue, ERROR otherwise
+ */
+int msgq_create(int max_bytes);
+
+/**
+ * @brief Get the message queue object
+ * 
+ * @param id 
+ * @return msgq_t* NULL if there's no queue with id
+ */
+msgq_t *get_msgq(int id);
+
+/**
+ * @brief copies a message into mq behind every message of the same or
+ * higher priority
+ * 
+ * @param mq 
+ * @param buf 
+ * @param len 
+ * @param prio 
+ * @return int 0 if success, ERROR if it didn't fit or malloc failed
+ */
+int msgq_put(msgq_t *mq, void *buf, int len, int prio);
+
+/**
+ * @brief takes the first message off mq, the caller frees it
+ * 
+ * @param mq 
+ * @return msg_t* NULL if mq is empty
+ */
+msg_t *msgq_take(msgq_t *mq);
+
+/**
+ * @brief frees the queue and any messages still in it
+ * 
+ * @param id 
+ * @return int 0 if success, ERROR if it doesn't exist or has blocked processes
+ */
+int msgq_reclaim(int id);
+
+#endif
@@ -25,10 +25,15 @@ pipe_t * init_head_pipe() {
     }
 
     // initialize variables
-    pipe->id = MAX_LOCKS + MAX_CVARS + 1; // pipe ids will be at the end of these things
+    pipe->id = PIPE_ID_BASE; // pipe ids will be at the end of these things
     pipe->next = NULL;
     pipe->plen = 0;
     pipe->being_used = PIPE_FREE;
+    pipe->lowat = 1;
+    pipe->lowat_ticks = 0;
+    pipe->queue = NULL;     // nobody waits on the head, the pipe calls reject its id
+    pipe->splice_to = NO_SPLICE;
+    pipe->tee_to = NO_SPLICE;
     memset(pipe->buf,0,PIPE_BUFFER_LEN);
     if (pipe->buf == NULL) {
         TracePrintf(0,"ERROR: init_head_pipe failed malloc for buf\n");
@@ -59,6 +64,10 @@ int add_pipe(pipe_t *head_pipe) {
     new_pipe->next = NULL;
     new_pipe->plen = 0;
     new_pipe->being_used = PIPE_FREE;
+    new_pipe->lowat = 1;
+    new_pipe->lowat_ticks = 0;
+    new_pipe->splice_to = NO_SPLICE;
+    new_pipe->tee_to = NO_SPLICE;
     memset(new_pipe->buf,0,PIPE_BUFFER_LEN);
     
     // initialize queue
@@ -118,6 +127,7 @@ int remove_pipe(pipe_t *head_pipe, int id) {
         pipe_before->next = curr_pipe->next; // If the current pipe is in the middle, set the pipe before to next pipe
     }
 
+    queue_delete(curr_pipe->queue, NULL);
     free(curr_pipe);
     return 0;
 }
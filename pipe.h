@@ -11,7 +11,11 @@ typedef struct pipe {
     int id;
     struct pipe *next;
     int being_used;     // flag variable, whether or not the pipe is being used
-    queue_t *queue;     // queue of processes waiting to read or write
+    queue_t *queue;     // queue of processes waiting to read
+    int lowat;          // readers wait for at least this many bytes...
+    int lowat_ticks;    // ...or this many ticks, then for any byte (0 = no limit)
+    int splice_to;      // terminal or pipe the kernel moves this pipe's bytes to, or NO_SPLICE
+    int tee_to;         // pipe that gets a copy of every byte written, or NO_SPLICE
 
 } pipe_t;
 
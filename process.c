@@ -11,6 +11,19 @@
 #include "process.h"
 #include "kernel.h"
 #include "include.h"
+#include "traphandlers.h"
+
+/**
+ * @brief copies between the current address space and pcb's region 1
+ * 
+ * @param pcb process on the other side of the copy
+ * @param user_addr address in pcb's region 1
+ * @param local address in the current address space
+ * @param len bytes to copy
+ * @param to_process 1 to copy local -> user_addr, 0 for user_addr -> local
+ * @return int 0 if success, ERROR otherwise
+ */
+static int CopyProcessPages(pcb_t *pcb, void *user_addr, void *local, int len, int to_process);
 
 /**
  * @brief 
@@ -24,20 +37,61 @@ pcb_t *init_process(UserContext *uctxt) {
         TracePrintf(0, "Error: User Context null in init_process\n");
     }
 
-    pcb_t *process = malloc(sizeof(pcb_t));
+    pcb_t *process = ReclaimingMalloc(sizeof(pcb_t));
 
     if (process == NULL) {
         TracePrintf(0, "Error: Init process failed.\n");
         return NULL;
     }
 
+    // region 1 page table, shared later with any threads the process creates
+    process->as = ReclaimingMalloc(sizeof(addr_space_t));
+    if (process->as == NULL) {
+        TracePrintf(0, "Error: Init process failed to make its page table.\n");
+        free(process);
+        return NULL;
+    }
+    process->as->users = 1;
+    process->user_page_table = process->as->page_table;
+
     // initialize all values to NULL or zero
     process->num_children = 0;
-    process->clock_ticks = 0;
     process->blocked_code = NOT_BLOCKED;
     process->exit_code = 0;
     process->tty_terminal = 0;
 
+    // message passing bookkeeping
+    process->senders = queue_init();
+    process->zombies = queue_init();
+    process->wait_pid = WAIT_ANY;
+    process->ipc_msg = NULL;
+    process->ipc_partner = 0;
+    process->ipc_result = 0;
+    process->sem_count = 0;
+    process->futex_key = 0;
+    process->poll_events = 0;
+    process->pipe_need = 0;
+    process->cvar_lock = 0;
+    process->ring = NULL;
+    memset(process->tty_stats, 0, sizeof(process->tty_stats));
+    process->wait_q = NULL;
+    process->deadline = 0;
+    process->timed_out = 0;
+    process->timer_next = NULL;
+    process->thread_stack_pg = 0;
+    process->thread_done = 0;
+    process->thread_killed = 0;
+    process->block_q = NULL;
+    process->joiner = NULL;
+    if (process->senders == NULL || process->zombies == NULL) {
+        TracePrintf(0, "Error: Init process failed to make senders queue.\n");
+        queue_delete(process->senders, NULL);
+        queue_delete(process->zombies, NULL);
+        free(process->as);
+        free(process);
+        return NULL;
+    }
+
     // user context and kernel context
     memset(&(process->user_context), 0, sizeof(UserContext));
     memset(&(process->kernel_context), 0, sizeof(KernelContext));
@@ -45,6 +99,7 @@ pcb_t *init_process(UserContext *uctxt) {
 
     // things to do with pid and parent pid
     process->pid = helper_new_pid(process->user_page_table);
+    process->tgid = process->pid;
     TracePrintf(0, "Allocated PID -> %d\n", process->pid);
     if (activePCB == NULL) {
         process->ppid = process->pid;
@@ -90,6 +145,10 @@ pcb_t *init_process(UserContext *uctxt) {
     process->user_text_pt_index = 0;
     process->user_data_pt_index = 0;
     
+    // make the process visible to lookups by pid
+    if (list_add(process_list, process) == ERROR) {
+        TracePrintf(0, "ERROR: init_process, adding to process list failed.\n");
+    }
 
     return process;
 }
@@ -97,12 +156,12 @@ pcb_t *init_process(UserContext *uctxt) {
 /**
  * @brief frees the address space within a given page table and kernel stack
  * 
- * @param u_pt 
+ * @param u_pt NULL to free only the kernel stack
  * @param k_stack 
  */
 int free_addr_space(pte_t *u_pt, pte_t *k_stack) {
 
-    if (u_pt == NULL || k_stack == NULL) {
+    if (k_stack == NULL) {
         TracePrintf(0, "ERROR: free_addr_space, null pte_t pointer.\n");
         return ERROR;
     }
@@ -116,6 +175,8 @@ int free_addr_space(pte_t *u_pt, pte_t *k_stack) {
             }
         }
     }
+    if (u_pt == NULL) return 0;
+
     // loops through user pagetable
     for (int i = 0; i < USER_PT_SIZE; i++) {
         if (u_pt[i].valid == VALID_FRAME) {
@@ -129,6 +190,55 @@ int free_addr_space(pte_t *u_pt, pte_t *k_stack) {
     return 0;
 }
 
+/**
+ * @brief returns the frames init_process reserved for pcb's kernel stack,
+ * for a process that never got far enough to run on it. They are only
+ * marked valid once KCCopy fills them in, so free_addr_space skips them.
+ * 
+ * @param pcb 
+ */
+void free_kernel_stack(pcb_t *pcb) {
+    for (int i = 0; i < KERNEL_STACK_SIZE; i++) {
+        if (pcb->kernel_stack_pt[i].valid == INVALID_FRAME && pcb->kernel_stack_pt[i].pfn != 0) {
+            DeallocatePFN(pcb->kernel_stack_pt[i].pfn);
+            pcb->kernel_stack_pt[i].pfn = 0;
+        }
+    }
+}
+
+/**
+ * @brief frees pcb's kernel stack and thread stack and drops its share of
+ * region 1, freeing that too if pcb was the last one using it
+ * 
+ * @param pcb 
+ */
+int drop_addr_space(pcb_t *pcb) {
+    if (pcb == NULL) {
+        TracePrintf(0, "ERROR: drop_addr_space, null pcb_t pointer.\n");
+        return ERROR;
+    }
+    addr_space_t *as = pcb->as;
+    if (as == NULL) return 0;
+
+    // a thread's stack is its own, the rest of region 1 is shared
+    for (int i = pcb->thread_stack_pg; pcb->thread_stack_pg > 0 && i < pcb->thread_stack_pg + THREAD_STACK_PAGES; i++) {
+        DeallocatePFN(as->page_table[i].pfn);
+        as->page_table[i].valid = INVALID_FRAME;
+        as->page_table[i].pfn = 0;
+        as->page_table[i].prot = NO_X_NO_W_NO_R;
+        WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (i << PAGESHIFT));
+    }
+
+    as->users--;
+    if (free_addr_space(as->users == 0 ? as->page_table : NULL, pcb->kernel_stack_pt) == ERROR) {
+        return ERROR;
+    }
+    if (as->users == 0) free(as);
+    pcb->as = NULL;
+    pcb->user_page_table = NULL;
+    return 0;
+}
+
 /**
  * @brief deletes the given process by freeing its page table and kernel stack
  * 
@@ -139,11 +249,148 @@ int delete_process(pcb_t *pcb) {
         TracePrintf(0, "ERROR: delete_process, null pcb_t pointer.\n");
         return ERROR;
     }
-    free_addr_space(pcb->user_page_table, pcb->kernel_stack_pt);
+    drop_addr_space(pcb);
+    list_remove(process_list, pcb, NULL);
+    queue_delete(pcb->senders, NULL);
+    queue_delete(pcb->zombies, NULL);
     free(pcb);
     return 0;
 }
 
+/**
+ * @brief finds a live process by pid
+ * 
+ * @param pid 
+ * @return pcb_t* NULL if no such process
+ */
+pcb_t *find_process(int pid) {
+    if (process_list == NULL) return NULL;
+    for (lnode_t *node = process_list->head; node != NULL; node = node->next) {
+        pcb_t *pcb = (pcb_t *) node->data;
+        if (pcb->pid == pid) return pcb;
+    }
+    return NULL;
+}
+
+/**
+ * @brief checks that [addr, addr + len) lies in valid region 1 pages of u_pt
+ * 
+ * @param u_pt page table to check against
+ * @param addr start of the buffer
+ * @param len length of the buffer
+ * @param prot protection bits every page must have (e.g. PROT_WRITE)
+ * @return int 0 if valid, ERROR otherwise
+ */
+int ValidUserRange(pte_t *u_pt, void *addr, int len, int prot) {
+    if (u_pt == NULL || addr == NULL || len < 0) return ERROR;
+    if ((unsigned int) addr < VMEM_1_BASE || (unsigned int) addr + len > VMEM_1_LIMIT) return ERROR;
+    if (len == 0) return 0;
+
+    int first = ((unsigned int) addr - VMEM_1_BASE) >> PAGESHIFT;
+    int last = ((unsigned int) addr + len - 1 - VMEM_1_BASE) >> PAGESHIFT;
+    for (int i = first; i <= last; i++) {
+        if (u_pt[i].valid != VALID_FRAME || (u_pt[i].prot & prot) != prot) {
+            return ERROR;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief copies len bytes from src in the current address space to dst in
+ * the region 1 of pcb, by mapping pcb's frames into a reserved kernel page
+ * 
+ * @param pcb process whose memory we write
+ * @param dst address in pcb's region 1
+ * @param src address readable from the current address space
+ * @param len 
+ * @return int 0 if success, ERROR otherwise
+ */
+int CopyToProcess(pcb_t *pcb, void *dst, void *src, int len) {
+    if (pcb == NULL || ValidUserRange(pcb->user_page_table, dst, len, PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: CopyToProcess, invalid destination %p (%d bytes)\n", dst, len);
+        return ERROR;
+    }
+    return CopyProcessPages(pcb, dst, src, len, 1);
+}
+
+/**
+ * @brief copies len bytes from src in the region 1 of pcb to dst in the
+ * current address space
+ * 
+ * @param pcb process whose memory we read
+ * @param dst address writable in the current address space
+ * @param src address in pcb's region 1
+ * @param len 
+ * @return int 0 if success, ERROR otherwise
+ */
+int CopyFromProcess(pcb_t *pcb, void *dst, void *src, int len) {
+    if (pcb == NULL || ValidUserRange(pcb->user_page_table, src, len, PROT_READ) == ERROR) {
+        TracePrintf(0, "ERROR: CopyFromProcess, invalid source %p (%d bytes)\n", src, len);
+        return ERROR;
+    }
+    return CopyProcessPages(pcb, src, dst, len, 0);
+}
+
+static int CopyProcessPages(pcb_t *pcb, void *user_addr, void *local, int len, int to_process) {
+
+    // if pcb's region 1 is the one currently mapped, copy directly
+    if (pcb->user_page_table == (pte_t *) ReadRegister(REG_PTBR1)) {
+        if (to_process) memcpy(user_addr, local, len);
+        else memcpy(local, user_addr, len);
+        return 0;
+    }
+
+    pte_t *k_pt = ( pte_t *) ReadRegister(REG_PTBR0);
+    int kernel_stack_base = (int) KERNEL_STACK_BASE >> PAGESHIFT;
+    int kernel_base = (int) VMEM_0_BASE >> PAGESHIFT;
+
+    // find an invalid frame to be reserved for the copy, same as KernelFork
+    int reserved_kernel_index = -1;
+    for (int index = kernel_stack_base; index >= kernel_base; index--) {
+        if (k_pt[index].valid == INVALID_FRAME) {
+            reserved_kernel_index = index;
+            break;
+        }
+    }
+    if (reserved_kernel_index == -1) {
+        TracePrintf(0, "ERROR: CopyProcessPages, no free kernel page to map through\n");
+        return ERROR;
+    }
+
+    void *window = (void *) (reserved_kernel_index << PAGESHIFT);
+    k_pt[reserved_kernel_index].valid = VALID_FRAME;
+    k_pt[reserved_kernel_index].prot = NO_X_W_R;
+
+    // copy one page of the other process at a time through the window
+    unsigned int addr = (unsigned int) user_addr;
+    char *cursor = (char *) local;
+    while (len > 0) {
+        int page = (addr - VMEM_1_BASE) >> PAGESHIFT;
+        int offset = addr & PAGEOFFSET;
+        int chunk = PAGESIZE - offset;
+        if (chunk > len) chunk = len;
+
+        k_pt[reserved_kernel_index].pfn = pcb->user_page_table[page].pfn;
+        WriteRegister(REG_TLB_FLUSH, (unsigned int) window);
+
+        if (to_process) memcpy(window + offset, cursor, chunk);
+        else memcpy(cursor, window + offset, chunk);
+
+        addr += chunk;
+        cursor += chunk;
+        len -= chunk;
+    }
+
+    // give the reserved page back
+    k_pt[reserved_kernel_index].pfn = 0;
+    k_pt[reserved_kernel_index].valid = INVALID_FRAME;
+    k_pt[reserved_kernel_index].prot = NO_X_NO_W_NO_R;
+    WriteRegister(REG_TLB_FLUSH, (unsigned int) window);
+
+    return 0;
+}
+
 /**
  * @brief copies user page table
  * 
@@ -171,8 +418,16 @@ int CopyUPT(pte_t *u_pt1, pte_t *u_pt2, pte_t *k_pt, int reserved_kernel_index)
     // for each page in region1
     for (int i = 0; i < USER_PT_SIZE; i++) {    // allocate and copy user page table
 
+        // shared frames (e.g. shared memory) are mapped, not copied
+        if (u_pt1[i].valid == VALID_FRAME && pfn_refcount[u_pt1[i].pfn] > 0) {
+            pfn_refcount[u_pt1[i].pfn]++;
+            u_pt2[i].pfn = u_pt1[i].pfn;
+            u_pt2[i].prot = u_pt1[i].prot;
+            u_pt2[i].valid = VALID_FRAME;
+        }
+
         // if it's valid
-        if (u_pt1[i].valid == VALID_FRAME) {
+        else if (u_pt1[i].valid == VALID_FRAME) {
             // allocate some pfn for it
             int pfn = AllocatePFN();
             if (pfn == -1) {
@@ -257,14 +512,20 @@ int SwapProcess(queue_t *moveActive, UserContext *uctxt) {
                 return ERROR;
             }
         }
+        // remember where we wait, so a thread can be pulled out if its process exits
+        activePCB->block_q = move != ready_q ? move : NULL;
         activePCB = next;
 
         KernelContextSwitch(KCSwitch, tmp, next);
+        activePCB->block_q = NULL;
 
         // update sp and pc of uctxt for the new activePCB
         uctxt->sp = activePCB->user_context.sp;
         uctxt->pc = activePCB->user_context.pc;
 
+        // a thread whose process exited ends wherever it wakes up
+        if (activePCB->thread_killed) KernelThreadExit(ERROR, uctxt);
+
         return 0;
     }
 }
\ No newline at end of file
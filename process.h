@@ -10,21 +10,33 @@
 
 #include "hardware.h"
 #include "include.h"
+#include <yalnix.h>
+
+/*
+ * A region 1 page table and the number of PCBs running on it: a process
+ * and the threads it created. The frames go with the last of them.
+ */
+typedef struct addr_space {
+    pte_t page_table[USER_PT_SIZE];
+    int users;
+} addr_space_t;
 
 typedef struct PCB {
     u_long pid; // pid
     u_long ppid; // parent pid
 
     int num_children; // number of children
-    int clock_ticks;
     int exit_code;
+    struct queue *zombies;  // exited children not waited for yet, oldest first
+    int wait_pid;           // child a blocked WaitPid is waiting for, WAIT_ANY for any
 
     // context information for process
     UserContext user_context; // hardware.h provides UserContext
     KernelContext kernel_context;  // hardware.h provides KernelContext
 
     // process user address space info, this is the FIRST ADDRESS of each segment
-    pte_t user_page_table[USER_PT_SIZE]; // region 1
+    pte_t *user_page_table; // region 1, as->page_table
+    addr_space_t *as;       // shared with our threads, NULL once dropped
 
     // user address space information (will be needed for brk etc)
     int user_stack_pt_index;
@@ -38,6 +50,34 @@ typedef struct PCB {
     int tty_terminal;
     int return_code;
 
+    // message passing
+    struct queue *senders;  // processes blocked in Send to this process
+    void *ipc_msg;          // buffer of a pending Send or Receive, in this process's region 1
+    int ipc_partner;        // pid on the other end of the exchange, 0 for any
+    int ipc_result;         // result handed back when a blocked Send/Receive is woken
+
+    int sem_count;          // units a blocked SemDown is waiting for
+    unsigned int futex_key; // physical address a blocked FutexWait is waiting on
+    int poll_events;        // POLL_* kinds a blocked Poll cares about
+    int pipe_need;          // bytes a blocked PipeRead is waiting for
+    int cvar_lock;          // lock a blocked CvarWait reacquires on wakeup
+    struct ring *ring;      // submission ring set up by RingSetup, in region 1
+    tty_write_stats_t tty_stats[NUM_TERMINALS]; // TtyWrite counters, per terminal
+
+    // timeouts, see timer.h
+    struct queue *wait_q;   // queue the process blocked in with a timeout
+    int deadline;           // clock tick the timeout expires at
+    int timed_out;          // set when the timer, not an event, woke the process
+    struct PCB *timer_next; // next armed process, by deadline
+
+    // threads, see KernelThreadCreate
+    int tgid;               // pid of the process a thread was created in, own pid for a process
+    int thread_stack_pg;    // first page of a thread's stack, 0 for a process
+    int thread_done;        // thread has exited and waits in thread_done_q to be joined
+    int thread_killed;      // its process exited, so the thread ends on its way back to user mode
+    struct queue *block_q;  // queue SwapProcess left the process waiting in, NULL for none or ready_q
+    struct PCB *joiner;     // who is blocked in ThreadJoin on this thread
+
 } pcb_t;
 
 /**
@@ -57,6 +97,14 @@ pcb_t *init_process(UserContext *uctxt);
  */
 int free_addr_space(pte_t *u_pt, pte_t *k_stack);
 
+/**
+ * @brief returns the frames init_process reserved for pcb's kernel stack,
+ * for a process that never got far enough to run on it
+ * 
+ * @param pcb 
+ */
+void free_kernel_stack(pcb_t *pcb);
+
 /**
  * @brief 
  * 
@@ -68,6 +116,16 @@ int free_addr_space(pte_t *u_pt, pte_t *k_stack);
  */
 int CopyUPT(pte_t *u_pt1, pte_t *u_pt2, pte_t *k_pt, int reserved_kernel_index);
 
+/**
+ * @brief frees pcb's kernel stack and thread stack and drops its share of
+ * region 1, freeing that too if pcb was the last one using it. Safe to
+ * call again on the same pcb.
+ * 
+ * @param pcb 
+ * @return int
+ */
+int drop_addr_space(pcb_t *pcb);
+
 /**
  * @brief 
  * 
@@ -76,4 +134,47 @@ int CopyUPT(pte_t *u_pt1, pte_t *u_pt2, pte_t *k_pt, int reserved_kernel_index);
  */
 int delete_process(pcb_t *pcb);
 
+/**
+ * @brief finds a live process by pid
+ * 
+ * @param pid 
+ * @return pcb_t* NULL if no such process
+ */
+pcb_t *find_process(int pid);
+
+/**
+ * @brief checks that [addr, addr + len) lies in valid region 1 pages of u_pt
+ * 
+ * @param u_pt page table to check against
+ * @param addr start of the buffer
+ * @param len length of the buffer
+ * @param prot protection bits every page must have (e.g. PROT_WRITE)
+ * @return int 0 if valid, ERROR otherwise
+ */
+int ValidUserRange(pte_t *u_pt, void *addr, int len, int prot);
+
+/**
+ * @brief copies len bytes from src in the current address space to dst in
+ * the region 1 of pcb, by mapping pcb's frames into a reserved kernel page
+ * 
+ * @param pcb process whose memory we write
+ * @param dst address in pcb's region 1
+ * @param src address readable from the current address space
+ * @param len 
+ * @return int 0 if success, ERROR otherwise
+ */
+int CopyToProcess(pcb_t *pcb, void *dst, void *src, int len);
+
+/**
+ * @brief copies len bytes from src in the region 1 of pcb to dst in the
+ * current address space
+ * 
+ * @param pcb process whose memory we read
+ * @param dst address writable in the current address space
+ * @param src address in pcb's region 1
+ * @param len 
+ * @return int 0 if success, ERROR otherwise
+ */
+int CopyFromProcess(pcb_t *pcb, void *dst, void *src, int len);
+
 #endif
\ No newline at end of file
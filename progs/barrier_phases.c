@@ -0,0 +1,54 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define WORKERS 4
+#define PHASES 3
+
+/*
+ * Four workers run three phases, meeting at one barrier after each. Nobody
+ * may start a phase before everyone has finished the one before it, and
+ * exactly one worker per phase gets BARRIER_SERIAL back.
+ */
+
+typedef struct state {
+    int finished[PHASES];   // workers done with each phase
+    int serials[PHASES];    // BARRIER_SERIAL returns in each phase
+    int early;              // workers that started a phase too soon
+} state_t;
+
+int main(int argc, char const *argv[]) {
+    int barrier, shm_id, status;
+    state_t *state;
+    if (BarrierInit(&barrier, WORKERS) == ERROR) {
+        TracePrintf(1, "barrier_phases.c: BarrierInit failed\n");
+        Exit(-1);
+    }
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &state);
+
+    for (int w = 0; w < WORKERS; w++) {
+        if (Fork() == 0) {
+            for (int p = 0; p < PHASES; p++) {
+                if (p > 0 && state->finished[p - 1] != WORKERS) state->early++;
+                // uneven work so workers reach the barrier at different times
+                Delay(w);
+                state->finished[p]++;
+                if (BarrierWait(barrier) == BARRIER_SERIAL) state->serials[p]++;
+            }
+            Exit(0);
+        }
+    }
+    for (int w = 0; w < WORKERS; w++) Wait(&status);
+
+    for (int p = 0; p < PHASES; p++) {
+        TracePrintf(1, "barrier_phases.c: phase %d: %d finished, %d serial (expect %d, 1)\n",
+                    p, state->finished[p], state->serials[p], WORKERS);
+    }
+    TracePrintf(1, "barrier_phases.c: %d early starts (expect 0)\n", state->early);
+
+    ShmDetach(state);
+    Reclaim(shm_id);
+    Reclaim(barrier);
+    return 0;
+}
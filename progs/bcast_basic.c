@@ -0,0 +1,57 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define SUBSCRIBERS 3
+
+/*
+ * One writer fans a message out to three subscribers through a blocking
+ * channel, then a drop channel is overrun to show lost byte reporting.
+ */
+
+int main(int argc, char const *argv[]) {
+    int chan, ready;
+    BcastInit(&chan, BCAST_BLOCK);
+    SemInit(&ready, 0);
+
+    char msg[] = "the same bytes for everyone";
+    int len = strlen(msg);
+
+    for (int i = 0; i < SUBSCRIBERS; i++) {
+        if (Fork() == 0) {
+            BcastSubscribe(chan);
+            SemUp(ready);
+
+            char buf[64];
+            int got = 0;
+            while (got < len) got += BcastRead(chan, buf + got, len - got);
+            buf[got] = '\0';
+            TracePrintf(1, "bcast_basic.c: subscriber %d read \"%s\"\n", GetPid(), buf);
+            Exit(0);
+        }
+    }
+
+    // only bytes written after a subscription are seen, wait for everyone
+    SemDownN(ready, SUBSCRIBERS);
+    TracePrintf(1, "bcast_basic.c: BcastWrite returned %d\n", BcastWrite(chan, msg, len));
+
+    int status;
+    for (int i = 0; i < SUBSCRIBERS; i++) Wait(&status);
+    TracePrintf(1, "bcast_basic.c: BcastRead without subscribing returned %d (expect %d)\n",
+                BcastRead(chan, msg, 1), ERROR);
+
+    // overrun a drop channel: the writer never waits, the reader loses the oldest bytes
+    int lossy;
+    BcastInit(&lossy, BCAST_DROP);
+    BcastSubscribe(lossy);
+    char big[1500];
+    memset(big, 'x', sizeof(big));
+    TracePrintf(1, "bcast_basic.c: drop channel BcastWrite returned %d\n", BcastWrite(lossy, big, sizeof(big)));
+    TracePrintf(1, "bcast_basic.c: read %d, lost %d (expect 1024, 476)\n",
+                BcastRead(lossy, big, sizeof(big)), BcastLost(lossy));
+
+    Reclaim(lossy);
+    Reclaim(chan);
+    Reclaim(ready);
+    return 0;
+}
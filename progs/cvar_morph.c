@@ -0,0 +1,59 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define WAITERS 4
+
+/*
+ * A broadcast while the lock is held moves every waiter straight onto the
+ * lock's queue; they then get the lock one after another through handoffs,
+ * each running once, instead of waking up only to block on the lock again.
+ */
+
+typedef struct state {
+    int go;
+    int done;
+} state_t;
+
+int main(int argc, char const *argv[]) {
+    int lock, cvar, shm_id;
+    state_t *state;
+    LockInit(&lock);
+    CvarInit(&cvar);
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &state);
+
+    for (int i = 0; i < WAITERS; i++) {
+        if (Fork() == 0) {
+            Acquire(lock);
+            while (!state->go) CvarWait(cvar, lock);
+            state->done++;
+            Release(lock);
+            Exit(0);
+        }
+    }
+
+    // let everyone get to CvarWait
+    Delay(3);
+
+    lock_stats_t before, after;
+    LockStats(lock, &before);
+    Acquire(lock);
+    state->go = 1;
+    CvarBroadcast(cvar);
+    Release(lock);
+
+    int status;
+    for (int i = 0; i < WAITERS; i++) Wait(&status);
+    LockStats(lock, &after);
+
+    TracePrintf(1, "cvar_morph.c: %d of %d waiters done\n", state->done, WAITERS);
+    TracePrintf(1, "cvar_morph.c: broadcast caused %d handoffs (expect %d)\n",
+                after.handoffs - before.handoffs, WAITERS);
+
+    ShmDetach(state);
+    Reclaim(shm_id);
+    Reclaim(cvar);
+    Reclaim(lock);
+    return 0;
+}
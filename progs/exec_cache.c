@@ -0,0 +1,37 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define RUNS 5
+
+/*
+ * Execs progs/to_exec from RUNS children in a row. Only the first should
+ * read the file; the rest come out of the kernel's image cache.
+ */
+
+int main(int argc, char const *argv[]) {
+    exec_cache_stats_t before, after;
+    char *args[] = {"progs/to_exec", NULL};
+    int status;
+
+    ExecCacheStats(&before);
+    for (int i = 0; i < RUNS; i++) {
+        int pid = Fork();
+        if (pid == 0) {
+            Exec("progs/to_exec", args);
+            TracePrintf(1, "exec_cache.c: Exec failed\n");
+            Exit(-1);
+        }
+        Wait(&status);
+    }
+    ExecCacheStats(&after);
+
+    TracePrintf(1, "exec_cache.c: misses -> %d (expect 1)\n", after.misses - before.misses);
+    TracePrintf(1, "exec_cache.c: hits -> %d (expect %d)\n", after.hits - before.hits, RUNS - 1);
+    TracePrintf(1, "exec_cache.c: entries -> %d, pages -> %d, evictions -> %d\n",
+                after.entries, after.pages, after.evictions);
+
+    TracePrintf(1, "exec_cache.c: bad stats pointer -> %d (expect %d)\n",
+                ExecCacheStats(NULL), ERROR);
+    return 0;
+}
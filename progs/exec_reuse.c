@@ -0,0 +1,56 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define GENERATIONS 4
+
+/*
+ * Execs itself GENERATIONS times, one argument fewer each time. Every
+ * generation dirties its bss, stack and (on odd generations) a big heap
+ * before the next Exec, which reuses those frames. The new image must
+ * still see a zeroed bss and its own arguments.
+ */
+
+static char bss[3 * PAGESIZE];
+
+int main(int argc, char *argv[]) {
+    char name[] = "progs/exec_reuse";
+    char *args[GENERATIONS + 2];
+    int bad = 0;
+
+    for (int i = 0; i < (int) sizeof(bss); i++) {
+        if (bss[i] != 0) bad++;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (atoi(argv[i]) != i) bad++;
+    }
+    TracePrintf(1, "exec_reuse.c: argc %d, dirty bss bytes or bad args -> %d (expect 0)\n",
+                argc, bad);
+
+    if (argc == 2) {
+        TracePrintf(1, "exec_reuse.c: done\n");
+        return 0;
+    }
+
+    // dirty everything the next image will get handed
+    memset(bss, 0x5a, sizeof(bss));
+    char stack[2 * PAGESIZE];
+    memset(stack, 0x5a, sizeof(stack));
+    if (argc % 2 == 1) {
+        char *heap = malloc(8 * PAGESIZE);
+        if (heap != NULL) memset(heap, 0x5a, 8 * PAGESIZE);
+    }
+
+    static char nums[GENERATIONS + 1][4];
+    int next = argc == 1 ? GENERATIONS + 1 : argc - 1;
+    args[0] = name;
+    for (int i = 1; i < next; i++) {
+        nums[i][0] = '0' + i;
+        nums[i][1] = '\0';
+        args[i] = nums[i];
+    }
+    args[next] = NULL;
+    Exec(name, args);
+    TracePrintf(1, "exec_reuse.c: Exec failed\n");
+    return -1;
+}
@@ -0,0 +1,61 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define WAITERS 3
+
+/*
+ * Three children queue up on a held lock in a known order and must get it
+ * in that order; TryAcquire and AcquireTimeout on the held lock give up,
+ * and LockStats counts what happened.
+ */
+
+typedef struct order {
+    int next;
+    int who[WAITERS];
+} order_t;
+
+int main(int argc, char const *argv[]) {
+    int lock, shm_id;
+    order_t *order;
+    LockInit(&lock);
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &order);
+
+    Acquire(lock);
+    for (int i = 0; i < WAITERS; i++) {
+        if (Fork() == 0) {
+            // stagger the arrivals so the queue order is known
+            Delay(i + 1);
+            Acquire(lock);
+            order->who[order->next++] = i;
+            Release(lock);
+            Exit(0);
+        }
+    }
+
+    if (Fork() == 0) {
+        TracePrintf(1, "lock_fair.c: TryAcquire returned %d (expect %d)\n", TryAcquire(lock), WOULD_BLOCK);
+        TracePrintf(1, "lock_fair.c: AcquireTimeout returned %d (expect %d)\n", AcquireTimeout(lock, 2), TIMED_OUT);
+        Exit(0);
+    }
+
+    Delay(WAITERS + 3);
+    Release(lock);
+
+    int status;
+    for (int i = 0; i < WAITERS + 1; i++) Wait(&status);
+
+    for (int i = 0; i < WAITERS; i++) {
+        TracePrintf(1, "lock_fair.c: turn %d went to waiter %d (expect %d)\n", i, order->who[i], i);
+    }
+    lock_stats_t stats;
+    LockStats(lock, &stats);
+    TracePrintf(1, "lock_fair.c: acquires %d contended %d handoffs %d timeouts %d (expect 4 4 3 1)\n",
+                stats.acquires, stats.contended, stats.handoffs, stats.timeouts);
+
+    ShmDetach(order);
+    Reclaim(shm_id);
+    TracePrintf(1, "lock_fair.c: Reclaim returned %d\n", Reclaim(lock));
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define ECHO_SERVICE 1
+
+// every message is 32 bytes
+typedef struct echo_msg {
+    int op;
+    int len;
+    char *data;     // buffer in the client's address space
+    char pad[20];
+} echo_msg_t;
+
+int main(int argc, char const *argv[]) {
+    int pid = GetPid();
+    TracePrintf(1, "msg_passing.c: PID -> %d\n", pid);
+
+    if (Register(ECHO_SERVICE) == ERROR) {
+        TracePrintf(1, "msg_passing.c: Register failed\n");
+        Exit(-1);
+    }
+
+    int rc = Fork();
+
+    if (rc == 0) {
+        // client: send a request naming a buffer the server fills in place
+        char *text = malloc(64);
+        strcpy(text, "hello from the client");
+
+        echo_msg_t msg;
+        msg.op = 1;
+        msg.len = strlen(text) + 1;
+        msg.data = text;
+
+        for (int i = 0; i < 3; i++) {
+            int res = Send(&msg, -ECHO_SERVICE);
+            TracePrintf(1, "msg_passing.c: client Send returned %d, reply op %d, buffer \"%s\"\n", res, msg.op, text);
+            msg.op = 1;
+        }
+
+        // a Send to a process that doesn't exist should fail
+        TracePrintf(1, "msg_passing.c: Send to bogus pid returned %d\n", Send(&msg, 12345));
+        Exit(0);
+    }
+
+    // server: receive, copy the client's data over, upper-case it and copy it back
+    char buf[64];
+    for (int i = 0; i < 3; i++) {
+        echo_msg_t msg;
+        int client = Receive(&msg);
+        TracePrintf(1, "msg_passing.c: server received op %d len %d from %d\n", msg.op, msg.len, client);
+
+        CopyFrom(client, buf, msg.data, msg.len);
+        for (int j = 0; buf[j] != 0; j++) {
+            if (buf[j] >= 'a' && buf[j] <= 'z') buf[j] = buf[j] - 'a' + 'A';
+        }
+        CopyTo(client, msg.data, buf, msg.len);
+
+        msg.op = 2;
+        Reply(&msg, client);
+    }
+
+    int status;
+    Wait(&status);
+    TracePrintf(1, "msg_passing.c: client exited with %d\n", status);
+
+    // waiting on a message from a process that exits without sending one
+    int quiet = Fork();
+    if (quiet == 0) {
+        Delay(2);
+        Exit(0);
+    }
+    echo_msg_t none;
+    TracePrintf(1, "msg_passing.c: ReceiveSpecific from an exiting process returned %d (expect %d)\n",
+                ReceiveSpecific(&none, quiet), ERROR);
+    Wait(&status);
+    return 0;
+}
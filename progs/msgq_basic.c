@@ -0,0 +1,67 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+/*
+ * Messages keep their boundaries and come out by priority, a message can be
+ * bigger than a pipe's buffer, and a full queue holds back the sender until
+ * the receiver makes room. A woken receiver whose buffer is too small hands
+ * the message on to the next one.
+ */
+
+int main(int argc, char const *argv[]) {
+    int mq;
+    MsgqInit(&mq, 512);
+
+    // no receiver yet, the sends still return right away
+    MsgqSend(mq, "low", 4, 1);
+    MsgqSend(mq, "high", 5, 5);
+    MsgqSend(mq, "middle", 7, 3);
+
+    char buf[400];
+    int prio;
+    TracePrintf(1, "msgq_basic.c: 2 byte buffer returned %d (expect %d)\n", MsgqReceive(mq, buf, 2, &prio), ERROR);
+    for (int i = 0; i < 3; i++) {
+        int n = MsgqReceive(mq, buf, sizeof(buf), &prio);
+        TracePrintf(1, "msgq_basic.c: got \"%s\" (%d bytes, priority %d)\n", buf, n, prio);
+    }
+
+    if (Fork() == 0) {
+        Delay(3);
+        for (int i = 0; i < 2; i++) {
+            int n = MsgqReceive(mq, buf, sizeof(buf), NULL);
+            TracePrintf(1, "msgq_basic.c: child got a %d byte message starting '%c'\n", n, buf[0]);
+        }
+        Exit(0);
+    }
+
+    // two 300 byte messages don't fit a 512 byte queue, the second waits
+    char big[300];
+    memset(big, 'A', sizeof(big));
+    MsgqSend(mq, big, sizeof(big), 0);
+    memset(big, 'B', sizeof(big));
+    MsgqSend(mq, big, sizeof(big), 0);
+    TracePrintf(1, "msgq_basic.c: both big messages queued\n");
+
+    int status;
+    Wait(&status);
+
+    // the small receiver queues first, so the send wakes it
+    if (Fork() == 0) {
+        TracePrintf(1, "msgq_basic.c: small receiver returned %d (expect %d)\n",
+                    MsgqReceive(mq, buf, 2, NULL), ERROR);
+        Exit(0);
+    }
+    Delay(1);
+    if (Fork() == 0) {
+        int n = MsgqReceive(mq, buf, sizeof(buf), NULL);
+        TracePrintf(1, "msgq_basic.c: next receiver got \"%s\" (%d bytes, expect 5)\n", buf, n);
+        Exit(0);
+    }
+    Delay(1);
+    MsgqSend(mq, "pass", 5, 0);
+    Wait(&status);
+    Wait(&status);
+    TracePrintf(1, "msgq_basic.c: Reclaim returned %d\n", Reclaim(mq));
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+/*
+ * A producer trickles one byte per tick into a pipe. With a low watermark
+ * of 8 the consumer's reads come back in batches of 8 instead of one byte
+ * each; with a 10 tick limit the last, short batch still arrives.
+ */
+
+#define BYTES 20
+
+int main(int argc, char const *argv[]) {
+    int pipe_id;
+    PipeInit(&pipe_id);
+    TracePrintf(1, "pipe_lowat.c: bad watermark returned %d (expect %d)\n",
+                PipeSetLowat(pipe_id, 0, 0), ERROR);
+    PipeSetLowat(pipe_id, 8, 10);
+
+    if (Fork() == 0) {
+        for (int i = 0; i < BYTES; i++) {
+            char c = 'a' + i;
+            PipeWrite(pipe_id, &c, 1);
+            Delay(1);
+        }
+        Exit(0);
+    }
+
+    int total = 0, reads = 0;
+    char buf[BYTES + 1];
+    while (total < BYTES) {
+        int n = PipeRead(pipe_id, buf, BYTES);
+        buf[n] = '\0';
+        TracePrintf(1, "pipe_lowat.c: read %d bytes \"%s\"\n", n, buf);
+        total += n;
+        reads++;
+    }
+    TracePrintf(1, "pipe_lowat.c: %d bytes in %d reads\n", total, reads);
+
+    int status;
+    Wait(&status);
+    Reclaim(pipe_id);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+/*
+ * One process serves two pipes and its children's exits with Poll instead
+ * of a helper process per source.
+ */
+
+static void writer(int pipe_id, int ticks, char *msg) {
+    Delay(ticks);
+    PipeWrite(pipe_id, msg, strlen(msg));
+    Exit(0);
+}
+
+int main(int argc, char const *argv[]) {
+    int a, b;
+    PipeInit(&a);
+    PipeInit(&b);
+
+    poll_entry_t set[3];
+    set[0].id = a;
+    set[0].events = POLL_PIPE_READ;
+    set[1].id = b;
+    set[1].events = POLL_PIPE_READ;
+    set[2].id = 0;
+    set[2].events = POLL_CHILD_EXIT;
+
+    // nothing is ready yet
+    TracePrintf(1, "poll_basic.c: check only returned %d (expect 0)\n", Poll(set, 3, 0));
+    TracePrintf(1, "poll_basic.c: 2 tick timeout returned %d (expect 0)\n", Poll(set, 3, 2));
+
+    if (Fork() == 0) writer(a, 3, "from a");
+    if (Fork() == 0) writer(b, 6, "from b");
+
+    int children = 2;
+    char buf[32];
+    while (children > 0) {
+        int n = Poll(set, 3, 20);
+        if (n <= 0) {
+            TracePrintf(1, "poll_basic.c: Poll returned %d\n", n);
+            break;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (set[i].revents & POLL_PIPE_READ) {
+                int len = PipeRead(set[i].id, buf, sizeof(buf) - 1);
+                buf[len] = '\0';
+                TracePrintf(1, "poll_basic.c: pipe %d readable: \"%s\"\n", set[i].id, buf);
+            }
+        }
+        if (set[2].revents & POLL_CHILD_EXIT) {
+            int status;
+            Wait(&status);
+            children--;
+            TracePrintf(1, "poll_basic.c: child exited with %d, %d left\n", status, children);
+        }
+    }
+
+    // a pipe with room is writable, a bad id is flagged
+    set[0].events = POLL_PIPE_WRITE;
+    set[1].id = 12345;
+    TracePrintf(1, "poll_basic.c: Poll returned %d, revents %x %x (expect %x %x)\n",
+                Poll(set, 2, 0), set[0].revents, set[1].revents, POLL_PIPE_WRITE, POLL_INVALID);
+
+    Reclaim(a);
+    Reclaim(b);
+    return 0;
+}
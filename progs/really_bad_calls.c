@@ -45,6 +45,10 @@ int main(int argc, char const *argv[]) {
     rc = Reclaim(2000);
     TracePrintf(1,"really_bad_calls.c: got return code %d\n",rc);
 
+    TracePrintf(1,"really_bad_calls.c: calling Reclaim with negative id\n");
+    rc = Reclaim(-1);
+    TracePrintf(1,"really_bad_calls.c: got return code %d\n",rc);
+
     TracePrintf(1,"really_bad_calls.c: calling exec with invalid program\n");
     rc = Exec("invalid","suuuper invalid");
     // exec won't return, we kill the process
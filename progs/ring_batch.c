@@ -0,0 +1,103 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define BENCH_TICKS 5
+#define BATCH 16
+
+/*
+ * Batches pipe writes/reads and semaphore ups through the submission ring,
+ * then counts how many write+read pairs finish in BENCH_TICKS ticks with one
+ * trap per call versus one RingEnter per batch. A forked child submits
+ * through its own copy of the ring, leaving the parent's alone.
+ */
+
+static volatile int *stop;
+
+static void start_timer(void) {
+    *stop = 0;
+    if (Fork() == 0) {
+        Delay(BENCH_TICKS);
+        *stop = 1;
+        Exit(0);
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    ring_t *ring;
+    if (RingSetup(&ring) == ERROR) {
+        TracePrintf(1, "ring_batch.c: RingSetup failed\n");
+        Exit(ERROR);
+    }
+    TracePrintf(1, "ring_batch.c: second RingSetup returned %d (expect %d)\n", RingSetup(&ring), ERROR);
+
+    int pipe_id, sem_id;
+    PipeInit(&pipe_id);
+    SemInit(&sem_id, 0);
+
+    // one batch: write, read back, bump a semaphore, and a bad op
+    char out[] = "ring";
+    char in[8];
+    RingPush(ring, RING_OP_PIPE_WRITE, pipe_id, out, 4, 1);
+    RingPush(ring, RING_OP_PIPE_READ, pipe_id, in, sizeof(in), 2);
+    RingPush(ring, RING_OP_SEM_UP, sem_id, NULL, 3, 3);
+    RingPush(ring, 99, 0, NULL, 0, 4);
+    TracePrintf(1, "ring_batch.c: RingSubmit ran %d ops (expect 4)\n", RingSubmit(ring));
+
+    ring_cqe_t cqe;
+    while (RingPop(ring, &cqe) == 0) {
+        TracePrintf(1, "ring_batch.c: op %d -> %d\n", cqe.user_data, cqe.result);
+    }
+    in[4] = '\0';
+    TracePrintf(1, "ring_batch.c: read back \"%s\", SemDownN(3) returned %d\n", in, SemDownN(sem_id, 3));
+
+    // the child's ring is a copy of ours, not ours
+    int status;
+    int parent_tail = ring->sq_tail;
+    if (Fork() == 0) {
+        RingPush(ring, RING_OP_NOP, 0, NULL, 0, 5);
+        TracePrintf(1, "ring_batch.c: RingSubmit in the child ran %d ops (expect 1)\n", RingSubmit(ring));
+        Exit(0);
+    }
+    Wait(&status);
+    TracePrintf(1, "ring_batch.c: parent sq_tail %d -> %d after the child's submit (expect no change)\n",
+                parent_tail, ring->sq_tail);
+
+    // throughput: shared flag ends each round
+    int shm_id;
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &stop);
+
+    int direct = 0;
+    start_timer();
+    while (!*stop) {
+        for (int i = 0; i < BATCH / 2; i++) {
+            PipeWrite(pipe_id, out, 4);
+            PipeRead(pipe_id, in, 4);
+        }
+        direct += BATCH / 2;
+    }
+    Wait(&status);
+
+    int batched = 0;
+    start_timer();
+    while (!*stop) {
+        for (int i = 0; i < BATCH / 2; i++) {
+            RingPush(ring, RING_OP_PIPE_WRITE, pipe_id, out, 4, i);
+            RingPush(ring, RING_OP_PIPE_READ, pipe_id, in, 4, i);
+        }
+        RingSubmit(ring);
+        while (RingPop(ring, &cqe) == 0);
+        batched += BATCH / 2;
+    }
+    Wait(&status);
+
+    TracePrintf(1, "ring_batch.c: write+read pairs in %d ticks: direct %d, ring %d\n",
+                BENCH_TICKS, direct, batched);
+
+    ShmDetach((void *) stop);
+    Reclaim(shm_id);
+    Reclaim(sem_id);
+    Reclaim(pipe_id);
+    return 0;
+}
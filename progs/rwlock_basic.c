@@ -0,0 +1,95 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define READERS 3
+
+/*
+ * Readers queued behind a writer all get the lock together when it's
+ * released. Then, while those readers hold it, a writer arrives and a late
+ * reader after it: with writer preference the late reader goes last.
+ */
+
+typedef struct state {
+    int inside;         // readers holding the lock right now
+    int most_inside;    // most readers seen holding it at once
+    int order_len;
+    char order[4];      // who got the lock after the first readers
+} state_t;
+
+int main(int argc, char const *argv[]) {
+    int rw, shm_id, status;
+    state_t *state;
+    if (RWLockInit(&rw) == ERROR) {
+        TracePrintf(1, "rwlock_basic.c: RWLockInit failed\n");
+        Exit(-1);
+    }
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &state);
+
+    RWLockWrite(rw);
+    for (int i = 0; i < READERS; i++) {
+        if (Fork() == 0) {
+            RWLockRead(rw);
+            state->inside++;
+            if (state->inside > state->most_inside) state->most_inside = state->inside;
+            Delay(3);
+            state->inside--;
+            RWLockRelease(rw);
+            Exit(0);
+        }
+    }
+    Delay(2);
+    RWLockRelease(rw);
+
+    // the readers now hold the lock; a writer queues, then a late reader
+    if (Fork() == 0) {
+        RWLockWrite(rw);
+        state->order[state->order_len++] = 'W';
+        RWLockRelease(rw);
+        Exit(0);
+    }
+    Delay(1);
+    if (Fork() == 0) {
+        RWLockRead(rw);
+        state->order[state->order_len++] = 'R';
+        RWLockRelease(rw);
+        Exit(0);
+    }
+
+    for (int i = 0; i < READERS + 2; i++) Wait(&status);
+
+    lock_stats_t stats;
+    LockStats(rw, &stats);
+    TracePrintf(1, "rwlock_basic.c: %d readers held the lock at once (expect %d)\n",
+                state->most_inside, READERS);
+    TracePrintf(1, "rwlock_basic.c: order after them %c%c (expect WR)\n",
+                state->order[0], state->order[1]);
+    TracePrintf(1, "rwlock_basic.c: %d read waits over %d ticks, %d write waits over %d ticks\n",
+                stats.read_waits, stats.read_wait_ticks, stats.write_waits, stats.write_wait_ticks);
+
+    // a reader-writer lock isn't a plain lock
+    if (Acquire(rw) != ERROR) TracePrintf(1, "rwlock_basic.c: Acquire on an rwlock should fail\n");
+
+    // a read hold on one lock doesn't let us drop a reader's hold on another
+    int other;
+    RWLockInit(&other);
+    if (Fork() == 0) {
+        RWLockRead(other);
+        Delay(3);
+        RWLockRelease(other);
+        Exit(0);
+    }
+    Delay(1);
+    RWLockRead(rw);
+    TracePrintf(1, "rwlock_basic.c: release of a lock we don't read returned %d (expect %d)\n",
+                RWLockRelease(other), ERROR);
+    RWLockRelease(rw);
+    Wait(&status);
+    Reclaim(other);
+
+    ShmDetach(state);
+    Reclaim(shm_id);
+    Reclaim(rw);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+int main(int argc, char const *argv[]) {
+    int pid = GetPid();
+    TracePrintf(1, "sem_basic.c: PID -> %d\n", pid);
+
+    int items;
+    SemInit(&items, 0);
+    TracePrintf(1, "sem_basic.c: got semaphore %d\n", items);
+
+    // the id has to land somewhere we can write
+    TracePrintf(1, "sem_basic.c: SemInit into kernel memory returned %d (expect %d)\n",
+                SemInit((int *) 0x1000, 0), ERROR);
+
+    // nothing to take yet
+    TracePrintf(1, "sem_basic.c: SemTryDown on empty returned %d (expect %d)\n", SemTryDown(items), WOULD_BLOCK);
+
+    int rc = Fork();
+
+    if (rc == 0) {
+        // consumer: take one, then a batch of three
+        SemDown(items);
+        TracePrintf(1, "sem_basic.c: consumer took 1\n");
+        SemDownN(items, 3);
+        TracePrintf(1, "sem_basic.c: consumer took 3 more\n");
+        Exit(0);
+    }
+
+    // producer: hand out items slowly, then in one batch
+    Delay(2);
+    TracePrintf(1, "sem_basic.c: producer up 1\n");
+    SemUp(items);
+    Delay(2);
+    TracePrintf(1, "sem_basic.c: producer up 5\n");
+    SemUpN(items, 5);
+
+    int status;
+    Wait(&status);
+
+    // 5 + 1 - 4 = 2 left over
+    TracePrintf(1, "sem_basic.c: SemTryDown returned %d, %d\n", SemTryDown(items), SemTryDown(items));
+    TracePrintf(1, "sem_basic.c: third SemTryDown returned %d\n", SemTryDown(items));
+    TracePrintf(1, "sem_basic.c: Reclaim returned %d\n", Reclaim(items));
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+int main(int argc, char const *argv[]) {
+    int pid = GetPid();
+    TracePrintf(1, "shm_basic.c: PID -> %d\n", pid);
+
+    int shm_id;
+    if (ShmInit(&shm_id, 2) == ERROR) {
+        TracePrintf(1, "shm_basic.c: ShmInit failed\n");
+        Exit(-1);
+    }
+
+    int *shared;
+    if (ShmAttach(shm_id, (void **) &shared) == ERROR) {
+        TracePrintf(1, "shm_basic.c: ShmAttach failed\n");
+        Exit(-1);
+    }
+    TracePrintf(1, "shm_basic.c: segment %d mapped at %p, first word %d\n", shm_id, shared, shared[0]);
+
+    shared[0] = 1;
+
+    int rc = Fork();
+
+    if (rc == 0) {
+        // the child inherits the mapping; the frames are the same, not copied
+        TracePrintf(1, "shm_basic.c: child sees %d\n", shared[0]);
+        shared[0] = 42;
+
+        // a second attach gives another view of the same frames
+        int *again;
+        ShmAttach(shm_id, (void **) &again);
+        TracePrintf(1, "shm_basic.c: child second mapping at %p sees %d\n", again, again[0]);
+        ShmDetach(again);
+        Exit(0);
+    }
+
+    int status;
+    Wait(&status);
+    TracePrintf(1, "shm_basic.c: parent sees %d after child exit (expect 42)\n", shared[0]);
+
+    // reclaim drops the segment, our mapping keeps the frames alive until detach
+    Reclaim(shm_id);
+    TracePrintf(1, "shm_basic.c: after Reclaim parent still sees %d\n", shared[0]);
+    ShmDetach(shared);
+    TracePrintf(1, "shm_basic.c: attach after reclaim returned %d\n", ShmAttach(shm_id, (void **) &shared));
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define BENCH_TICKS 10
+#define BIG_PAGES 48
+
+/*
+ * Counts how many times progs/to_exec can be launched and waited for in
+ * BENCH_TICKS clock ticks, with Fork then Exec versus Spawn. Each is run
+ * from a small parent and again after the parent grows its heap by
+ * BIG_PAGES pages: Fork has to copy those pages, Spawn shouldn't care.
+ */
+
+static volatile int *stop;
+
+static int run(int use_spawn) {
+    char *args[] = {"progs/to_exec", NULL};
+    int launches = 0;
+    int status;
+
+    *stop = 0;
+    // timer: ends the round after BENCH_TICKS
+    if (Fork() == 0) {
+        Delay(BENCH_TICKS);
+        *stop = 1;
+        Exit(0);
+    }
+    while (!*stop) {
+        if (use_spawn) {
+            if (Spawn(args[0], args) == ERROR) break;
+        } else if (Fork() == 0) {
+            Exec(args[0], args);
+            Exit(-1);
+        }
+        launches++;
+        Wait(&status);
+    }
+    // one of the Waits above may have reaped the timer; whichever of it and
+    // the last launch is left goes here
+    Wait(&status);
+    return launches;
+}
+
+int main(int argc, char const *argv[]) {
+    int shm_id;
+    if (ShmInit(&shm_id, 1) == ERROR || ShmAttach(shm_id, (void **) &stop) == ERROR) {
+        TracePrintf(1, "spawn_bench.c: shared memory setup failed\n");
+        Exit(ERROR);
+    }
+
+    char *bad[] = {"progs/no_such_program", NULL};
+    TracePrintf(1, "spawn_bench.c: Spawn of a missing program -> %d (expect %d)\n",
+                Spawn(bad[0], bad), ERROR);
+
+    int forked = run(0);
+    int spawned = run(1);
+    TracePrintf(1, "spawn_bench.c: small parent, %d ticks: Fork+Exec %d, Spawn %d\n",
+                BENCH_TICKS, forked, spawned);
+
+    char *heap = malloc(BIG_PAGES * PAGESIZE);
+    if (heap == NULL) {
+        TracePrintf(1, "spawn_bench.c: malloc failed\n");
+        Exit(ERROR);
+    }
+    memset(heap, 1, BIG_PAGES * PAGESIZE);
+
+    forked = run(0);
+    spawned = run(1);
+    TracePrintf(1, "spawn_bench.c: parent +%d pages, %d ticks: Fork+Exec %d, Spawn %d (expect Spawn about the same as before)\n",
+                BIG_PAGES, BENCH_TICKS, forked, spawned);
+
+    ShmDetach((void *) stop);
+    Reclaim(shm_id);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+/*
+ * Log lines written to a pipe spliced to terminal 1 show up there without
+ * any process reading them; a tee copies one pipe's stream into another;
+ * a pipe-to-pipe splice moves bytes straight through.
+ */
+
+int main(int argc, char const *argv[]) {
+    int log, a, copy, c, d;
+    PipeInit(&log);
+    PipeInit(&a);
+    PipeInit(&copy);
+    PipeInit(&c);
+    PipeInit(&d);
+
+    // pipe -> terminal
+    Splice(log, 1);
+    for (int i = 0; i < 5; i++) {
+        char line[] = "splice_basic.c: log line N\n";
+        line[strlen(line) - 2] = '0' + i;
+        PipeWrite(log, line, strlen(line));
+        Delay(1);
+    }
+
+    // tee: both a and copy get the bytes
+    Tee(a, copy);
+    PipeWrite(a, "twice", 5);
+    char buf[16];
+    int n1 = PipeRead(a, buf, sizeof(buf));
+    int n2 = PipeRead(copy, buf, sizeof(buf));
+    TracePrintf(1, "splice_basic.c: tee read %d from the pipe and %d from the copy (expect 5, 5)\n", n1, n2);
+
+    // pipe -> pipe, and no loops
+    Splice(c, d);
+    PipeWrite(c, "moved", 5);
+    int n = PipeRead(d, buf, sizeof(buf));
+    buf[n] = '\0';
+    TracePrintf(1, "splice_basic.c: read \"%s\" from the far end\n", buf);
+    TracePrintf(1, "splice_basic.c: splicing back returned %d (expect %d)\n", Splice(d, c), ERROR);
+    TracePrintf(1, "splice_basic.c: second pipe on terminal 1 returned %d (expect %d)\n", Splice(a, 1), ERROR);
+
+    // give the terminal time to drain before tearing down
+    Delay(5);
+    Splice(log, SPLICE_NONE);
+    Reclaim(log);
+    Reclaim(a);
+    Reclaim(copy);
+    Reclaim(c);
+    Reclaim(d);
+    return 0;
+}
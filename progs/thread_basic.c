@@ -0,0 +1,118 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define THREADS 4
+#define ROUNDS 1000
+
+/*
+ * Four threads add to one global counter under a lock, so they only get
+ * the right total if they really share memory. Each first waits on a cvar
+ * until main says go, and returns its index as its exit code. Then a child
+ * exits with one thread still spinning, one blocked reading a pipe and one
+ * already done: the spinner has to stop with it, and the reader must not
+ * take anything written to the pipe afterwards.
+ */
+
+static int counter;
+static int go;
+static int lock;
+static int cvar;
+
+static int worker(void *arg) {
+    int me = (int) arg;
+
+    Acquire(lock);
+    while (!go) CvarWait(cvar, lock);
+    Release(lock);
+
+    for (int i = 0; i < ROUNDS; i++) {
+        Acquire(lock);
+        counter++;
+        Release(lock);
+        if (i % 250 == 0) Pause();
+    }
+    return me;
+}
+
+static int spinner(void *arg) {
+    int *ticks = (int *) arg;
+    while (1) {
+        (*ticks)++;
+        Delay(1);
+    }
+    return 0;
+}
+
+static int quitter(void *arg) {
+    return 0;
+}
+
+static int reader(void *arg) {
+    char c;
+    PipeRead((int) arg, &c, 1);
+    return 0;
+}
+
+int main(int argc, char const *argv[]) {
+    int tids[THREADS];
+    int status;
+
+    LockInit(&lock);
+    CvarInit(&cvar);
+
+    for (int i = 0; i < THREADS; i++) {
+        tids[i] = ThreadCreate(worker, (void *) i);
+        TracePrintf(1, "thread_basic.c: created thread %d\n", tids[i]);
+    }
+
+    Delay(2);
+    Acquire(lock);
+    TracePrintf(1, "thread_basic.c: counter before go -> %d (expect 0)\n", counter);
+    go = 1;
+    CvarBroadcast(cvar);
+    Release(lock);
+
+    for (int i = 0; i < THREADS; i++) {
+        int rc = ThreadJoin(tids[i], &status);
+        TracePrintf(1, "thread_basic.c: join %d -> %d, status %d (expect 0, %d)\n", tids[i], rc, status, i);
+    }
+    TracePrintf(1, "thread_basic.c: counter -> %d (expect %d)\n", counter, THREADS * ROUNDS);
+
+    TracePrintf(1, "thread_basic.c: join again -> %d (expect %d)\n", ThreadJoin(tids[0], &status), ERROR);
+    TracePrintf(1, "thread_basic.c: join myself -> %d (expect %d)\n", ThreadJoin(GetPid(), &status), ERROR);
+
+    // the child's threads live in its own copy of memory, so count in shm
+    int shm_id;
+    int *ticks;
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &ticks);
+    int pipe_id;
+    PipeInit(&pipe_id);
+    if (Fork() == 0) {
+        ThreadCreate(quitter, NULL);
+        ThreadCreate(spinner, ticks);
+        ThreadCreate(reader, (void *) pipe_id);
+        Delay(3);
+        Exit(0);
+    }
+    Wait(&status);
+    Delay(2);
+    int seen = *ticks;
+    Delay(3);
+    TracePrintf(1, "thread_basic.c: spinner ticks after its process exited %d -> %d (expect no change)\n",
+                seen, *ticks);
+
+    char c = 'x';
+    PipeWrite(pipe_id, &c, 1);
+    Delay(1);
+    TracePrintf(1, "thread_basic.c: pipe read after the blocked reader's process exited -> %d (expect 1)\n",
+                PipeRead(pipe_id, &c, 1));
+    Reclaim(pipe_id);
+    ShmDetach(ticks);
+    Reclaim(shm_id);
+
+    Reclaim(cvar);
+    Reclaim(lock);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+/*
+ * Each timed wait first runs out with nobody to wake it, then is woken in
+ * time by a child. A timed-out CvarWaitTimeout must still hold the lock.
+ */
+
+int main(int argc, char const *argv[]) {
+    int pipe, lock, cvar, status, rc;
+    char buf[16];
+    PipeInit(&pipe);
+    LockInit(&lock);
+    CvarInit(&cvar);
+
+    // PipeReadTimeout
+    rc = PipeReadTimeout(pipe, buf, sizeof(buf), 3);
+    TracePrintf(1, "timeouts.c: empty pipe read -> %d (expect %d)\n", rc, TIMED_OUT);
+    if (Fork() == 0) {
+        Delay(1);
+        PipeWrite(pipe, "hello", 5);
+        Exit(0);
+    }
+    rc = PipeReadTimeout(pipe, buf, sizeof(buf), 10);
+    TracePrintf(1, "timeouts.c: pipe read with a writer -> %d (expect 5)\n", rc);
+    Wait(&status);
+
+    // CvarWaitTimeout
+    Acquire(lock);
+    rc = CvarWaitTimeout(cvar, lock, 3);
+    TracePrintf(1, "timeouts.c: unsignalled cvar wait -> %d (expect %d)\n", rc, TIMED_OUT);
+    TracePrintf(1, "timeouts.c: release after the timeout -> %d (expect 0)\n", Release(lock));
+    if (Fork() == 0) {
+        Delay(1);
+        Acquire(lock);
+        CvarSignal(cvar);
+        Release(lock);
+        Exit(0);
+    }
+    Acquire(lock);
+    rc = CvarWaitTimeout(cvar, lock, 10);
+    TracePrintf(1, "timeouts.c: signalled cvar wait -> %d (expect 0)\n", rc);
+    Release(lock);
+    Wait(&status);
+
+    // AcquireTimeout
+    if (Fork() == 0) {
+        Acquire(lock);
+        Delay(5);
+        Release(lock);
+        Exit(0);
+    }
+    Delay(1);
+    rc = AcquireTimeout(lock, 2);
+    TracePrintf(1, "timeouts.c: acquire of a held lock -> %d (expect %d)\n", rc, TIMED_OUT);
+    rc = AcquireTimeout(lock, 10);
+    TracePrintf(1, "timeouts.c: acquire once it's released -> %d (expect 0)\n", rc);
+    Release(lock);
+    Wait(&status);
+
+    Reclaim(cvar);
+    Reclaim(lock);
+    Reclaim(pipe);
+    return 0;
+}
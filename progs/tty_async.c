@@ -0,0 +1,61 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+#include "hardware.h"
+
+#define LINE 64
+#define SMALL_LINES 40      // 2.5 KB, fits the output ring
+#define BIG_LINES 400       // 25 KB, more than the ring holds
+
+/*
+ * A child counts clock ticks in shared memory. Writes that fit the
+ * terminal's output ring return before any tick passes; a write larger than
+ * the ring waits for the terminal to drain part of it.
+ */
+
+typedef struct state {
+    int ticks;
+    int stop;
+} state_t;
+
+static char text[BIG_LINES * LINE];
+
+int main(int argc, char const *argv[]) {
+    int shm_id, status;
+    state_t *state;
+    ShmInit(&shm_id, 1);
+    ShmAttach(shm_id, (void **) &state);
+
+    if (Fork() == 0) {
+        while (!state->stop) {
+            Delay(1);
+            state->ticks++;
+        }
+        Exit(0);
+    }
+
+    for (int i = 0; i < BIG_LINES; i++) {
+        memset(text + i * LINE, 'a' + i % 26, LINE - 1);
+        text[i * LINE + LINE - 1] = '\n';
+    }
+
+    int before = state->ticks;
+    int rc = TtyWrite(1, text, SMALL_LINES * LINE);
+    int small_ticks = state->ticks - before;
+
+    before = state->ticks;
+    int big_rc = TtyWrite(1, text, BIG_LINES * LINE);
+    int big_ticks = state->ticks - before;
+
+    state->stop = 1;
+    Wait(&status);
+
+    TracePrintf(1, "tty_async.c: small write %d bytes, %d ticks (expect %d, 0)\n",
+                rc, small_ticks, SMALL_LINES * LINE);
+    TracePrintf(1, "tty_async.c: big write %d bytes, %d ticks (expect %d, > 0)\n",
+                big_rc, big_ticks, BIG_LINES * LINE);
+
+    ShmDetach(state);
+    Reclaim(shm_id);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+#include "hardware.h"
+
+#define LINE 64
+#define LOG_LINES 600       // more than the output ring holds, so the logger waits
+
+/*
+ * A logger writes a long burst to terminal 1; a second process writes one
+ * short line while the logger is still waiting for room. With writers
+ * taking turns a line at a time, the short line goes in behind what's
+ * already in the output ring instead of after the whole burst.
+ */
+
+static char text[LOG_LINES * LINE];
+
+int main(int argc, char const *argv[]) {
+    int status;
+    tty_write_stats_t stats;
+
+    if (Fork() == 0) {
+        for (int i = 0; i < LOG_LINES; i++) {
+            memset(text + i * LINE, 'a' + i % 26, LINE - 1);
+            text[i * LINE + LINE - 1] = '\n';
+        }
+        TtyWrite(1, text, sizeof(text));
+        TtyWriteStats(1, &stats);
+        TracePrintf(1, "tty_fair.c: logger queued %d bytes, waited %d times for %d ticks\n",
+                    stats.bytes, stats.waits, stats.wait_ticks);
+        Exit(0);
+    }
+
+    if (Fork() == 0) {
+        Delay(2);
+        TtyPrintf(1, ">>> short line from pid %d <<<\n", GetPid());
+        TtyWriteStats(1, &stats);
+        TracePrintf(1, "tty_fair.c: short writer queued %d bytes, waited %d times for %d ticks\n",
+                    stats.bytes, stats.waits, stats.wait_ticks);
+        Exit(0);
+    }
+
+    Wait(&status);
+    Wait(&status);
+    return 0;
+}
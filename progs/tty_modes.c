@@ -0,0 +1,36 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+#include "hardware.h"
+
+/*
+ * Lines typed while nobody is reading stay buffered. Cooked reads hand them
+ * back one line at a time; a raw read takes everything buffered at once.
+ */
+
+int main(int argc, char const *argv[]) {
+    char buf[TERMINAL_MAX_LINE + 1];
+    int rc;
+
+    TtyPrintf(0, "Type three lines in the next few seconds...\n");
+    Delay(20);
+    for (int i = 0; i < 3; i++) {
+        rc = TtyRead(0, buf, TERMINAL_MAX_LINE);
+        buf[rc] = '\0';
+        TtyPrintf(0, "cooked read %d: %d bytes: %s", i, rc, buf);
+    }
+
+    if (TtySetMode(0, TTY_RAW, 0) == ERROR) TtyPrintf(0, "TtySetMode raw failed\n");
+    TtyPrintf(0, "Raw now, type three more lines...\n");
+    Delay(20);
+    rc = TtyRead(0, buf, TERMINAL_MAX_LINE);
+    buf[rc] = '\0';
+    TtyPrintf(0, "raw read: %d bytes:\n%s", rc, buf);
+
+    // a buffer smaller than one terminal line isn't allowed
+    if (TtySetMode(0, TTY_COOKED, TERMINAL_MAX_LINE - 1) != ERROR) {
+        TtyPrintf(0, "TtySetMode should refuse a capacity below one line\n");
+    }
+    TtySetMode(0, TTY_COOKED, 0);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+#include "hardware.h"
+
+/*
+ * Checks for operator input between units of work without a reader
+ * process: TtyReadTimeout with 0 ticks returns 0 at once while nothing is
+ * typed. A timed read with nobody typing gives up with TIMED_OUT.
+ */
+
+int main(int argc, char const *argv[]) {
+    char buf[TERMINAL_MAX_LINE + 1];
+    int rc;
+
+    rc = TtyReadTimeout(0, buf, TERMINAL_MAX_LINE, 5);
+    TtyPrintf(0, "timed read with no input -> %d (expect %d)\n", rc, TIMED_OUT);
+
+    TtyPrintf(0, "Working; type a line to stop...\n");
+    int units = 0;
+    while ((rc = TtyReadTimeout(0, buf, TERMINAL_MAX_LINE, 0)) == 0) {
+        // a unit of work
+        Delay(1);
+        units++;
+        if (units % 10 == 0) TtyPrintf(0, "%d units done\n", units);
+    }
+    if (rc > 0) {
+        buf[rc] = '\0';
+        TtyPrintf(0, "stopped after %d units by: %s", units, buf);
+    } else {
+        TtyPrintf(0, "non-blocking read failed -> %d\n", rc);
+    }
+    return 0;
+}
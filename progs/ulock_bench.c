@@ -0,0 +1,78 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define BENCH_TICKS 5
+
+/*
+ * Compares the kernel lock (Acquire/Release) against the futex based user
+ * lock (ULockAcquire/ULockRelease). Each round counts how many lock/unlock
+ * pairs finish in BENCH_TICKS clock ticks, first with one worker
+ * (uncontended) and then with two workers fighting over the lock.
+ */
+
+typedef struct bench {
+    ulock_t ulock;
+    volatile int stop;
+    volatile int count[2];
+} bench_t;
+
+static bench_t *bench;
+static int klock;
+
+static void work(int use_ulock, int slot) {
+    while (!bench->stop) {
+        if (use_ulock) {
+            ULockAcquire(&bench->ulock);
+            bench->count[slot]++;
+            ULockRelease(&bench->ulock);
+        } else {
+            Acquire(klock);
+            bench->count[slot]++;
+            Release(klock);
+        }
+    }
+}
+
+static int run(int use_ulock, int workers) {
+    bench->stop = 0;
+    bench->count[0] = bench->count[1] = 0;
+
+    // timer: ends the round after BENCH_TICKS
+    if (Fork() == 0) {
+        Delay(BENCH_TICKS);
+        bench->stop = 1;
+        Exit(0);
+    }
+    if (workers > 1 && Fork() == 0) {
+        work(use_ulock, 1);
+        Exit(0);
+    }
+    work(use_ulock, 0);
+
+    int status;
+    for (int i = 0; i < workers; i++) Wait(&status);
+    return bench->count[0] + bench->count[1];
+}
+
+int main(int argc, char const *argv[]) {
+    int shm_id;
+    if (ShmInit(&shm_id, 1) == ERROR || ShmAttach(shm_id, (void **) &bench) == ERROR) {
+        TracePrintf(1, "ulock_bench.c: shared memory setup failed\n");
+        Exit(ERROR);
+    }
+    LockInit(&klock);
+    ULockInit(&bench->ulock);
+
+    for (int workers = 1; workers <= 2; workers++) {
+        int kernel = run(0, workers);
+        int user = run(1, workers);
+        TracePrintf(1, "ulock_bench.c: %d worker(s), %d ticks: Acquire/Release %d, ULock %d\n",
+                    workers, BENCH_TICKS, kernel, user);
+    }
+
+    Reclaim(klock);
+    ShmDetach(bench);
+    Reclaim(shm_id);
+    return 0;
+}
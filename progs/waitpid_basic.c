@@ -0,0 +1,55 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+#define CHILDREN 3
+
+/*
+ * Three children exit in order after 1, 4 and 7 ticks. The parent reaps
+ * the last one first by pid, then the other two with WAIT_ANY, oldest
+ * exit first. Then a supervisor loop does a unit of work per tick and
+ * checks on its child with WAIT_NOHANG until the child exits.
+ */
+
+int main(int argc, char const *argv[]) {
+    int pids[CHILDREN];
+    int status;
+    int rc;
+
+    for (int i = 0; i < CHILDREN; i++) {
+        pids[i] = Fork();
+        if (pids[i] == 0) {
+            Delay(3 * i + 1);
+            Exit(10 + i);
+        }
+    }
+
+    rc = WaitPid(pids[2], &status, WAIT_NOHANG);
+    TracePrintf(1, "waitpid_basic.c: no-hang on a running child -> %d (expect %d)\n", rc, WOULD_BLOCK);
+
+    rc = WaitPid(pids[2], &status, 0);
+    TracePrintf(1, "waitpid_basic.c: wait for %d -> %d, status %d (expect %d, 12)\n", pids[2], rc, status, pids[2]);
+    for (int i = 0; i < 2; i++) {
+        rc = WaitPid(WAIT_ANY, &status, 0);
+        TracePrintf(1, "waitpid_basic.c: wait for any -> %d, status %d (expect %d, %d)\n", rc, status, pids[i], 10 + i);
+    }
+    rc = WaitPid(pids[0], &status, 0);
+    TracePrintf(1, "waitpid_basic.c: wait for a reaped child -> %d (expect %d)\n", rc, ERROR);
+    rc = WaitPid(WAIT_ANY, NULL, WAIT_NOHANG);
+    TracePrintf(1, "waitpid_basic.c: wait with no children -> %d (expect %d)\n", rc, ERROR);
+
+    // supervisor: keep working while the child runs
+    int pid = Fork();
+    if (pid == 0) {
+        Delay(5);
+        Exit(7);
+    }
+    int units = 0;
+    while ((rc = WaitPid(pid, &status, WAIT_NOHANG)) == WOULD_BLOCK) {
+        Delay(1);
+        units++;
+    }
+    TracePrintf(1, "waitpid_basic.c: child %d exited with %d after %d units of work (expect %d, 7, about 5)\n",
+                rc, status, units, pid);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "ylib.h"
+#include "ykernel.h"
+#include "yuser.h"
+
+/*
+ * Sends a fixed size header plus payload as one vectored pipe write, splits
+ * it back apart with one vectored read, and writes a multi-part line to the
+ * console with a single TtyWritev. A vectored write into a nearly full pipe
+ * fails without writing any of its bytes.
+ */
+
+typedef struct header {
+    int type;
+    int len;
+} header_t;
+
+int main(int argc, char const *argv[]) {
+    int pipe_id;
+    PipeInit(&pipe_id);
+
+    header_t hdr = { 7, 11 };
+    char payload[] = "hello there";
+    io_vec_t out[2] = { { &hdr, sizeof(hdr) }, { payload, hdr.len } };
+    TracePrintf(1, "writev_basic.c: PipeWritev returned %d (expect %d)\n",
+                PipeWritev(pipe_id, out, 2), (int) sizeof(hdr) + hdr.len);
+
+    header_t got;
+    char body[32];
+    memset(body, 0, sizeof(body));
+    io_vec_t in[2] = { { &got, sizeof(got) }, { body, sizeof(body) - 1 } };
+    int n = PipeReadv(pipe_id, in, 2);
+    TracePrintf(1, "writev_basic.c: PipeReadv returned %d, type %d len %d body \"%s\"\n",
+                n, got.type, got.len, body);
+
+    // segments that don't validate fail the whole call
+    io_vec_t bad[2] = { { payload, 4 }, { NULL, 4 } };
+    TracePrintf(1, "writev_basic.c: PipeWritev with a NULL segment returned %d (expect %d)\n",
+                PipeWritev(pipe_id, bad, 2), ERROR);
+
+    // leave room for less than the header plus payload
+    char fill[PIPE_BUFFER_LEN];
+    memset(fill, 'x', sizeof(fill));
+    int room = sizeof(hdr) + 2;
+    TracePrintf(1, "writev_basic.c: filling the pipe wrote %d (expect %d)\n",
+                PipeWrite(pipe_id, fill, PIPE_BUFFER_LEN - room), PIPE_BUFFER_LEN - room);
+    TracePrintf(1, "writev_basic.c: PipeWritev into %d free bytes returned %d (expect %d)\n",
+                room, PipeWritev(pipe_id, out, 2), ERROR);
+    int drained = PipeRead(pipe_id, fill, PIPE_BUFFER_LEN);
+    TracePrintf(1, "writev_basic.c: pipe then held %d bytes (expect %d)\n",
+                drained, PIPE_BUFFER_LEN - room);
+
+    char *parts[] = { "writev_basic.c: ", "one line ", "from ", "four segments\n" };
+    io_vec_t line[4];
+    for (int i = 0; i < 4; i++) {
+        line[i].base = parts[i];
+        line[i].len = strlen(parts[i]);
+    }
+    TtyWritev(0, line, 4);
+
+    Reclaim(pipe_id);
+    return 0;
+}
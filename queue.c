@@ -99,6 +99,22 @@ int queue_add(queue_t *queue, pcb_t *data, int  id) {
  * - data with id in queue if success
  */
 pcb_t *queue_remove(queue_t *queue, int id) {
+    if (queue == NULL) return NULL;
+    qnode_t *prev = NULL;
+    for (qnode_t *node = queue->head; node != NULL; node = node->next) {
+        if (node->id == id) {
+            // unlink the node, fixing up head and tail
+            if (prev == NULL) queue->head = node->next;
+            else prev->next = node->next;
+            if (queue->tail == node) queue->tail = prev;
+            queue->size--;
+            pcb_t *data = node->data;
+            qnode_delete(node, NULL);
+            return data;
+        }
+        prev = node;
+    }
+    return NULL;
 }
 
 /**
@@ -155,6 +171,11 @@ int queue_size(queue_t *queue) {
  * - 1 if exists
  */
 int queue_find(queue_t *queue, int id) {
+    if (queue == NULL) return 0;
+    for (qnode_t *node = queue->head; node != NULL; node = node->next) {
+        if (node->id == id) return 1;
+    }
+    return 0;
 }
 
 /**
@@ -164,6 +185,14 @@ int queue_find(queue_t *queue, int id) {
  * @param dataDelete function pointer to a function to delete data in queue
  */
 void queue_delete(queue_t *queue, void (*dataDelete) (pcb_t *data)) {
+    if (queue == NULL) return;
+    qnode_t *node = queue->head;
+    while (node != NULL) {
+        qnode_t *next = node->next;
+        qnode_delete(node, dataDelete);
+        node = next;
+    }
+    free(queue);
 }
 
 /**
@@ -50,26 +50,17 @@ main(int argc, char *argv[])
       }
       while(cmd_argv[j++] = strtok(NULL, separators))
 	;
-      if(pid = Fork())
+      if((pid = Spawn(cmd_argv[0], cmd_argv)) == -1)
 	{
-	  if(pid == -1)
-	    {
-	      TracePrintf(0,"Shell: Cannot fork process\n");
-	      continue;
-	    }
-	  if ((pid = Wait(&res)) != -1) {
-	    TtyPrintf(termno, "PID %d exit status = %d\n", pid, res);
-	  }
-	  else {
-	    TtyPrintf(termno, "PID %d aborted by kernel.\n", pid);
-	  }
-	}
-      else
-	{
-	  Exec(cmd_argv[0], cmd_argv);
 	  TtyPrintf(termno, "Could not exec `%s'.\n", buf);
-	  Exit(-2);
+	  continue;
 	}
+      if ((pid = Wait(&res)) != -1) {
+	TtyPrintf(termno, "PID %d exit status = %d\n", pid, res);
+      }
+      else {
+	TtyPrintf(termno, "PID %d aborted by kernel.\n", pid);
+      }
     }
 }
 
@@ -0,0 +1,196 @@
+/*
+ * shm.c
+ *
+ * shared memory segments, see shm.h
+ */
+
+#include <ylib.h>
+#include <hardware.h>
+#include "shm.h"
+#include "kernel.h"
+#include "include.h"
+
+// segment with id SHM_ID_BASE + i lives at index i
+static shm_segment_t *shm_segments[MAX_SHM_SEGMENTS];
+
+/**
+ * @brief creates a segment of npages frames
+ * 
+ * @param npages 
+ * @return int id of the segment, ERROR otherwise
+ */
+int shm_create(int npages) {
+    if (npages <= 0 || npages > MAX_PT_LEN) return ERROR;
+
+    shm_sweep();
+
+    // find a free slot
+    int slot = -1;
+    for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+        if (shm_segments[i] == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == -1 || pfn_list->size < npages) {
+        TracePrintf(0, "ERROR: shm_create, out of segments or frames\n");
+        return ERROR;
+    }
+
+    shm_segment_t *seg = malloc(sizeof(shm_segment_t));
+    if (seg == NULL) return ERROR;
+    seg->pfns = malloc(sizeof(int) * npages);
+    if (seg->pfns == NULL) {
+        free(seg);
+        return ERROR;
+    }
+
+    for (int i = 0; i < npages; i++) {
+        seg->pfns[i] = AllocatePFN();
+        // the segment holds one reference of its own
+        pfn_refcount[seg->pfns[i]] = 1;
+    }
+    seg->id = SHM_ID_BASE + slot;
+    seg->npages = npages;
+    seg->reclaimed = 0;
+    seg->zeroed = 0;
+    shm_segments[slot] = seg;
+
+    TracePrintf(0, "shm_create: segment %d with %d pages\n", seg->id, npages);
+    return seg->id;
+}
+
+/**
+ * @brief Get the segment object
+ * 
+ * @param id 
+ * @return shm_segment_t* NULL if there's no live segment with id
+ */
+shm_segment_t *get_shm(int id) {
+    if (id < SHM_ID_BASE || id >= SHM_ID_BASE + MAX_SHM_SEGMENTS) return NULL;
+    shm_segment_t *seg = shm_segments[id - SHM_ID_BASE];
+    if (seg == NULL || seg->reclaimed) return NULL;
+    return seg;
+}
+
+/**
+ * @brief maps seg into the region 1 of pcb, in the highest free run of pages
+ * that leaves SHM_STACK_GAP pages of room below the stack
+ * 
+ * @param seg 
+ * @param pcb 
+ * @return int page table index of the first page, ERROR otherwise
+ */
+int shm_attach(shm_segment_t *seg, pcb_t *pcb) {
+    if (seg == NULL || pcb == NULL) return ERROR;
+    pte_t *u_pt = pcb->user_page_table;
+
+    // keep a guard page above the heap and room for the stack to grow
+    int lowest = pcb->user_heap_pt_index + 1;
+    int top = pcb->user_stack_pt_index - SHM_STACK_GAP;
+
+    int start = -1;
+    int run = 0;
+    for (int i = top - 1; i >= lowest; i--) {
+        if (u_pt[i].valid == INVALID_FRAME) {
+            run++;
+            if (run == seg->npages) {
+                start = i;
+                break;
+            }
+        } else {
+            run = 0;
+        }
+    }
+    if (start == -1) {
+        TracePrintf(0, "ERROR: shm_attach, no room for %d pages\n", seg->npages);
+        return ERROR;
+    }
+
+    for (int i = 0; i < seg->npages; i++) {
+        pfn_refcount[seg->pfns[i]]++;
+        u_pt[start + i].pfn = seg->pfns[i];
+        u_pt[start + i].prot = NO_X_W_R;
+        u_pt[start + i].valid = VALID_FRAME;
+        WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + ((start + i) << PAGESHIFT));
+    }
+
+    // the first attacher is always the active process, clear the frames through its mapping
+    if (!seg->zeroed && pcb == activePCB) {
+        memset((void *) (VMEM_1_BASE + (start << PAGESHIFT)), 0, seg->npages << PAGESHIFT);
+        seg->zeroed = 1;
+    }
+
+    return start;
+}
+
+/**
+ * @brief unmaps the segment whose first page is at page table index page
+ * 
+ * @param pcb 
+ * @param page 
+ * @return int 0 if success, ERROR otherwise
+ */
+int shm_detach(pcb_t *pcb, int page) {
+    if (pcb == NULL || page < 0 || page >= MAX_PT_LEN) return ERROR;
+    pte_t *u_pt = pcb->user_page_table;
+    if (u_pt[page].valid != VALID_FRAME) return ERROR;
+
+    // find the segment that starts at this frame
+    shm_segment_t *seg = NULL;
+    for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+        if (shm_segments[i] != NULL && shm_segments[i]->pfns[0] == u_pt[page].pfn) {
+            seg = shm_segments[i];
+            break;
+        }
+    }
+    if (seg == NULL || page + seg->npages > MAX_PT_LEN) {
+        TracePrintf(0, "ERROR: shm_detach, page %d is not the start of a segment\n", page);
+        return ERROR;
+    }
+
+    for (int i = 0; i < seg->npages; i++) {
+        DeallocatePFN(u_pt[page + i].pfn);
+        u_pt[page + i].valid = INVALID_FRAME;
+        u_pt[page + i].prot = NO_X_NO_W_NO_R;
+        u_pt[page + i].pfn = 0;
+        WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + ((page + i) << PAGESHIFT));
+    }
+
+    shm_sweep();
+    return 0;
+}
+
+/**
+ * @brief drops the segment's own reference to its frames
+ * 
+ * @param id 
+ * @return int 0 if success, ERROR otherwise
+ */
+int shm_reclaim(int id) {
+    shm_segment_t *seg = get_shm(id);
+    if (seg == NULL) return ERROR;
+
+    seg->reclaimed = 1;
+    for (int i = 0; i < seg->npages; i++) {
+        DeallocatePFN(seg->pfns[i]);
+    }
+    shm_sweep();
+    return 0;
+}
+
+/**
+ * @brief frees reclaimed segments that nobody has attached anymore
+ * 
+ */
+void shm_sweep() {
+    for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+        shm_segment_t *seg = shm_segments[i];
+        // once the last holder lets go the frame's count drops back to 0
+        if (seg != NULL && seg->reclaimed && pfn_refcount[seg->pfns[0]] == 0) {
+            free(seg->pfns);
+            free(seg);
+            shm_segments[i] = NULL;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef __SHM_H_
+#define __SHM_H_
+
+#include "process.h"
+
+/*
+ * shm.h
+ *
+ * shared memory segments: a fixed set of frames that can be mapped into the
+ * region 1 of several processes at once. Frames are reference counted through
+ * pfn_refcount, so a segment's memory lives until the segment is reclaimed
+ * and every process has detached or exited.
+ */
+
+typedef struct shm_segment {
+    int id;
+    int npages;
+    int *pfns;          // frames backing the segment
+    int reclaimed;      // Reclaim was called, frames go away with the last attacher
+    int zeroed;         // frames have been cleared (done on first attach)
+} shm_segment_t;
+
+/**
+ * @brief creates a segment of npages frames
+ * 
+ * @param npages 
+ * @return int id of the segment, ERROR otherwise
+ */
+int shm_create(int npages);
+
+/**
+ * @brief Get the segment object
+ * 
+ * @param id 
+ * @return shm_segment_t* NULL if there's no live segment with id
+ */
+shm_segment_t *get_shm(int id);
+
+/**
+ * @brief maps seg into the region 1 of pcb, in the highest free run of pages
+ * that leaves SHM_STACK_GAP pages of room below the stack
+ * 
+ * @param seg 
+ * @param pcb 
+ * @return int page table index of the first page, ERROR otherwise
+ */
+int shm_attach(shm_segment_t *seg, pcb_t *pcb);
+
+/**
+ * @brief unmaps the segment whose first page is at page table index page
+ * 
+ * @param pcb 
+ * @param page 
+ * @return int 0 if success, ERROR otherwise
+ */
+int shm_detach(pcb_t *pcb, int page);
+
+/**
+ * @brief drops the segment's own reference to its frames
+ * 
+ * @param id 
+ * @return int 0 if success, ERROR otherwise
+ */
+int shm_reclaim(int id);
+
+/**
+ * @brief frees reclaimed segments that nobody has attached anymore
+ * 
+ */
+void shm_sweep();
+
+#endif
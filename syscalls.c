@@ -4,6 +4,13 @@
 #include <ylib.h>
 #include "kernel.h"
 #include "process.h"
+#include "traphandlers.h"
+#include "shm.h"
+#include "timer.h"
+#include "bcast.h"
+#include "msgq.h"
+#include "tty.h"
+#include "image.h"
 
 // ********************************************************** 
 //                     Syscall Handlers
@@ -13,6 +20,39 @@
 // =    Basic process coordination 3.1.1    =
 // ==========================================
 
+/**
+ * @brief gives a forked child a private copy of its parent's submission
+ * ring. CopyUPT shares the ring's frame like any shared segment, so the
+ * child's mapping is moved onto a new one-page segment that only the child
+ * holds, at the same address.
+ * 
+ * @param child 
+ * @param k_pt 
+ * @param reserved_kernel_index kernel page to copy the ring through
+ * @return int 0 if success, ERROR otherwise
+ */
+static int ForkRing(pcb_t *child, pte_t *k_pt, int reserved_kernel_index) {
+    int page = ((unsigned int) activePCB->ring - VMEM_1_BASE) >> PAGESHIFT;
+    int id = shm_create(1);
+    if (id == ERROR) return ERROR;
+    shm_segment_t *seg = get_shm(id);
+    int pfn = seg->pfns[0];
+
+    k_pt[reserved_kernel_index].pfn = pfn;
+    WriteRegister(REG_TLB_FLUSH, (unsigned int) (reserved_kernel_index << PAGESHIFT));
+    memcpy((void *) (reserved_kernel_index << PAGESHIFT), activePCB->ring, PAGESIZE);
+    seg->zeroed = 1;
+
+    // swap the child's share of the parent's frame for the copy
+    DeallocatePFN(child->user_page_table[page].pfn);
+    pfn_refcount[pfn]++;
+    child->user_page_table[page].pfn = pfn;
+    child->ring = activePCB->ring;
+
+    // like RingSetup, the segment goes away with the child's mapping
+    return shm_reclaim(id);
+}
+
 /**
  * @brief 
  * 
@@ -67,6 +107,12 @@ int KernelFork(UserContext *uctxt) {
         return ERROR;
     }
 
+    // the child's ring can't be the parent's
+    if (activePCB->ring != NULL && ForkRing(childPCB, k_pt, reserved_kernel_index) == ERROR) {
+        TracePrintf(0,"ERROR: KernelFork, failed to copy the ring\n");
+        return ERROR;
+    }
+
     // free kernel index when done (make invalid)
     k_pt[reserved_kernel_index].pfn = 0;
     k_pt[reserved_kernel_index].valid = INVALID_FRAME;
@@ -103,9 +149,18 @@ int KernelExec(UserContext *uctxt, char *filename, char **argvec) {
         TracePrintf(0,"ERROR: KernelExec received a NULL argument\n");
         return ERROR;
     } 
+    // the new image would pull region 1 out from under our threads, and a
+    // thread can't become a process, even once the rest of its group is gone
+    if (activePCB->as->users > 1 || activePCB->thread_stack_pg > 0) {
+        TracePrintf(0,"ERROR: KernelExec called with live threads or from a thread\n");
+        return ERROR;
+    }
     // reset the user context
     memset(&(activePCB->user_context), 0, sizeof(UserContext));
 
+    // the ring page goes away with the old image
+    activePCB->ring = NULL;
+
     // flush the kernel stack tlb
     WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_KSTACK);
 
@@ -117,6 +172,361 @@ int KernelExec(UserContext *uctxt, char *filename, char **argvec) {
     return 0;
 }
 
+/**
+ * @brief Copies out the exec image cache's counters
+ * 
+ * @param statsp 
+ * @return int 
+ */
+int KernelExecCacheStats(exec_cache_stats_t *statsp) {
+    if (ValidUserRange(activePCB->user_page_table, statsp, sizeof(exec_cache_stats_t), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+    image_stats(statsp);
+    return SUCCESS;
+}
+
+/**
+ * @brief Starts a child running filename. The child gets a fresh region 1
+ * loaded straight from the program instead of a copy of ours, so the cost
+ * doesn't depend on how big the caller is.
+ * 
+ * @param uctxt 
+ * @param filename 
+ * @param argvec 
+ * @return int child's pid to the caller, 0 in the child, ERROR on failure
+ */
+int KernelSpawn(UserContext *uctxt, char *filename, char **argvec) {
+    if (uctxt == NULL || filename == NULL || argvec == NULL) {
+        TracePrintf(0,"ERROR: KernelSpawn received a NULL argument\n");
+        return ERROR;
+    }
+
+    // initialize child PCB, same parent/child bookkeeping as Fork
+    pcb_t *childPCB = init_process(uctxt);
+    if (childPCB == NULL) {
+        TracePrintf(0,"ERROR: child PCB in KernelSpawn is null.\n");
+        return ERROR;
+    }
+
+    // load the program into the child; LoadProgram points region 1 at the
+    // child's page table to do it, so point it back at ours afterwards
+    int rc = LoadProgram(filename, argvec, childPCB);
+    WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+    WriteRegister(REG_PTBR1, (unsigned int) activePCB->user_page_table);
+
+    if (rc == ERROR) {
+        TracePrintf(0,"ERROR: KernelSpawn failed to loadprogram.\n");
+        free_kernel_stack(childPCB);
+        activePCB->num_children--;
+        delete_process(childPCB);
+        return ERROR;
+    }
+
+    // add the childPCB to the ready queue
+    if (queue_add(ready_q, childPCB, childPCB->pid) == ERROR) {
+        TracePrintf(0,"ERROR: KernelSpawn, failed add to queue.\n");
+        free_kernel_stack(childPCB);
+        activePCB->num_children--;
+        delete_process(childPCB);
+        return ERROR;
+    }
+
+    // give the child a kernel stack to come back on
+    KernelContextSwitch(KCCopy, childPCB, NULL);
+
+    // the child leaves the kernel at the new program's entry point
+    if (activePCB->pid == childPCB->pid) {
+        uctxt->sp = activePCB->user_context.sp;
+        uctxt->pc = activePCB->user_context.pc;
+        return 0;
+    }
+    return childPCB->pid;
+}
+
+/**
+ * @brief Starts a thread at start(func, arg) that shares our region 1. It
+ * gets its own kernel stack and a THREAD_STACK_PAGES user stack, placed
+ * like a shared memory segment: in the highest free run between the heap
+ * and SHM_STACK_GAP pages below the main stack, over an unmapped guard page.
+ * 
+ * @param uctxt 
+ * @param start user entry point, called as start(func, arg)
+ * @param func 
+ * @param arg 
+ * @return int thread's pid to the caller, 0 in the thread, ERROR on failure
+ */
+int KernelThreadCreate(UserContext *uctxt, void *start, void *func, void *arg) {
+    if (uctxt == NULL || start == NULL || func == NULL) {
+        TracePrintf(0,"ERROR: KernelThreadCreate received a NULL argument\n");
+        return ERROR;
+    }
+    pte_t *u_pt = activePCB->user_page_table;
+
+    // room for the stack and its guard page
+    int lowest = activePCB->user_heap_pt_index + 1;
+    int top = activePCB->user_stack_pt_index - SHM_STACK_GAP;
+    int guard = -1;
+    int run = 0;
+    for (int i = top - 1; i >= lowest; i--) {
+        run = u_pt[i].valid == INVALID_FRAME ? run + 1 : 0;
+        if (run == THREAD_STACK_PAGES + 1) {
+            guard = i;
+            break;
+        }
+    }
+    if (guard == -1) {
+        TracePrintf(0,"ERROR: KernelThreadCreate, no room for a stack\n");
+        return ERROR;
+    }
+
+    pcb_t *thread = init_process(uctxt);
+    if (thread == NULL) {
+        TracePrintf(0,"ERROR: thread PCB in KernelThreadCreate is null.\n");
+        return ERROR;
+    }
+
+    // a thread is joined, not waited for, so it isn't one of our children
+    activePCB->num_children--;
+    thread->ppid = 0;
+    thread->tgid = activePCB->tgid;
+    thread->thread_killed = activePCB->thread_killed;
+
+    // run on our page table instead of the one init_process made
+    free(thread->as);
+    thread->as = activePCB->as;
+    thread->as->users++;
+    thread->user_page_table = u_pt;
+    thread->user_heap_pt_index = activePCB->user_heap_pt_index;
+    thread->user_stack_pt_index = activePCB->user_stack_pt_index;
+    thread->user_data_pt_index = activePCB->user_data_pt_index;
+    thread->user_text_pt_index = activePCB->user_text_pt_index;
+
+    thread->thread_stack_pg = guard + 1;
+    for (int i = guard + 1; i <= guard + THREAD_STACK_PAGES; i++) {
+        int pfn = AllocatePFN();
+        if (pfn == ERROR) {
+            TracePrintf(0,"ERROR: KernelThreadCreate, out of frames for the stack\n");
+            // unmap what we got
+            for (int j = guard + 1; j < i; j++) {
+                DeallocatePFN(u_pt[j].pfn);
+                u_pt[j].valid = INVALID_FRAME;
+                u_pt[j].pfn = 0;
+            }
+            thread->thread_stack_pg = 0;
+            free_kernel_stack(thread);
+            delete_process(thread);
+            return ERROR;
+        }
+        u_pt[i].pfn = pfn;
+        u_pt[i].prot = NO_X_W_R;
+        u_pt[i].valid = VALID_FRAME;
+        WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (i << PAGESHIFT));
+    }
+
+    // start(func, arg) with a 0 return address, arguments 16 byte aligned
+    unsigned int *args = (unsigned int *)
+        (VMEM_1_BASE + ((guard + 1 + THREAD_STACK_PAGES) << PAGESHIFT) - 16);
+    args[0] = (unsigned int) func;
+    args[1] = (unsigned int) arg;
+    args[-1] = 0;
+    thread->user_context.sp = (void *) (args - 1);
+    thread->user_context.pc = start;
+
+    // add the thread to the ready queue
+    if (queue_add(ready_q, thread, thread->pid) == ERROR) {
+        TracePrintf(0,"ERROR: KernelThreadCreate, failed add to queue.\n");
+        // delete_process unmaps the thread stack too
+        free_kernel_stack(thread);
+        delete_process(thread);
+        return ERROR;
+    }
+
+    // give the thread a kernel stack to come back on
+    KernelContextSwitch(KCCopy, thread, NULL);
+
+    // the thread leaves the kernel at start
+    if (activePCB->pid == thread->pid) {
+        uctxt->sp = activePCB->user_context.sp;
+        uctxt->pc = activePCB->user_context.pc;
+        return 0;
+    }
+    return thread->pid;
+}
+
+/**
+ * @brief orphans pcb's live children and frees the exited ones nobody
+ * waited for, as pcb goes away
+ * 
+ * @param pcb 
+ */
+static void ReleaseChildren(pcb_t *pcb) {
+    for (lnode_t *node = process_list->head; node != NULL; node = node->next) {
+        pcb_t *child = (pcb_t *) node->data;
+        if (child->ppid == pcb->pid) child->ppid = 0;
+    }
+    pcb_t *zombie;
+    while ((zombie = queue_pop(pcb->zombies)) != NULL) {
+        delete_process(zombie);
+    }
+}
+
+/**
+ * @brief frees group tgid's exited threads still waiting in thread_done_q,
+ * once nobody is left in the group to join them
+ * 
+ * @param tgid 
+ */
+static void ReapThreads(int tgid) {
+    // exited threads have left process_list, thread_done_q is all that has them
+    qnode_t *node = thread_done_q->head;
+    while (node != NULL) {
+        pcb_t *pcb = node->data;
+        node = node->next;
+        if (pcb->tgid == tgid) {
+            queue_remove(thread_done_q, pcb->pid);
+            delete_process(pcb);
+        }
+    }
+}
+
+static void TtyWakeWriter(int tty_id);
+
+/**
+ * @brief marks group tgid's live threads to end the next time they run, see
+ * SwapProcess and the end of TrapKernelHandler. Blocked ones are taken out
+ * of whatever they wait on and readied, so they get to run.
+ * 
+ * @param tgid 
+ */
+static void KillThreads(int tgid) {
+    for (lnode_t *node = process_list->head; node != NULL; node = node->next) {
+        pcb_t *pcb = (pcb_t *) node->data;
+        if (pcb->tgid != tgid || pcb->thread_stack_pg == 0 || pcb->thread_done) continue;
+        pcb->thread_killed = 1;
+
+        // a terminal writer stays in the write queue even once readied
+        if (queue_remove(ttyWriteQueues[pcb->tty_terminal], pcb->pid) != NULL) {
+            TtyWakeWriter(pcb->tty_terminal);
+        }
+        if (pcb->blocked_code == NOT_BLOCKED) continue;
+
+        timer_cancel(pcb);
+        if (pcb->block_q != NULL) queue_remove(pcb->block_q, pcb->pid);
+        pcb->block_q = NULL;
+        pcb->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, pcb, pcb->pid);
+    }
+}
+
+/**
+ * @brief Ends the calling thread. Its stacks are freed now; the PCB waits in
+ * thread_done_q with the exit code until ThreadJoin takes it, unless this
+ * was the last of its group, which then frees every exited thread of the
+ * group along with itself. From a process this is Exit.
+ * 
+ * @param exit_code 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelThreadExit(int exit_code, UserContext *uctxt) {
+    if (uctxt == NULL) {
+        TracePrintf(0,"ERROR: KernelThreadExit received a NULL argument\n");
+        return ERROR;
+    }
+    if (activePCB->thread_stack_pg == 0) {
+        return KernelExit(exit_code, uctxt);
+    }
+
+    // leave the process table and release anyone waiting on us for a message
+    IpcExit(activePCB);
+    bcast_exit(activePCB->pid);
+
+    activePCB->exit_code = exit_code;
+    activePCB->thread_done = 1;
+    ReleaseChildren(activePCB);
+
+    // a killed joiner gives up its join
+    for (lnode_t *node = process_list->head; node != NULL; node = node->next) {
+        pcb_t *pcb = (pcb_t *) node->data;
+        if (pcb->joiner == activePCB) pcb->joiner = NULL;
+    }
+
+    // with nobody left to join them, the group's exited threads go with us
+    int last = activePCB->as->users == 1;
+    if (drop_addr_space(activePCB) == ERROR) {
+        TracePrintf(0,"ERROR: KernelThreadExit, unable to free the thread's memory.\n");
+        return ERROR;
+    }
+
+    // shared segments we were the last holder of can go now
+    shm_sweep();
+
+    if (last) {
+        ReapThreads(activePCB->tgid);
+        if (delete_process(activePCB) == ERROR) {
+            TracePrintf(0,"ERROR: KernelThreadExit, unable to delete thread.\n");
+            return ERROR;
+        }
+        return SwapProcess(NULL, uctxt);
+    }
+
+    if (queue_add(thread_done_q, activePCB, activePCB->pid) == ERROR) {
+        TracePrintf(0,"ERROR: KernelThreadExit, unable to add to queue.\n");
+        return ERROR;
+    }
+    // a joiner killed along with us has been readied already
+    pcb_t *joiner = activePCB->joiner;
+    if (joiner != NULL && joiner->blocked_code == BLOCKED_THREAD_JOIN) {
+        joiner->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, joiner, joiner->pid);
+    }
+    return SwapProcess(NULL, uctxt);
+}
+
+/**
+ * @brief Waits for thread tid of our process to exit and frees it
+ * 
+ * @param tid 
+ * @param status_ptr where to put its exit code, may be NULL
+ * @param uctxt 
+ * @return int 0 if success, ERROR if tid isn't a thread of ours or someone
+ * else is already joining it
+ */
+int KernelThreadJoin(int tid, int *status_ptr, UserContext *uctxt) {
+    if (uctxt == NULL) {
+        TracePrintf(0,"ERROR: KernelThreadJoin received a NULL argument\n");
+        return ERROR;
+    }
+    if (status_ptr != NULL && ValidUserRange(activePCB->user_page_table, status_ptr, sizeof(int), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+
+    pcb_t *thread = queue_remove(thread_done_q, tid);
+    if (thread != NULL && thread->tgid != activePCB->tgid) {
+        queue_add(thread_done_q, thread, thread->pid);
+        return ERROR;
+    }
+
+    // still running: wait for KernelThreadExit to put it in thread_done_q
+    if (thread == NULL) {
+        thread = find_process(tid);
+        if (thread == NULL || thread == activePCB || thread->thread_stack_pg == 0 ||
+            thread->tgid != activePCB->tgid || thread->joiner != NULL) {
+            return ERROR;
+        }
+        thread->joiner = activePCB;
+        activePCB->blocked_code = BLOCKED_THREAD_JOIN;
+        SwapProcess(NULL, uctxt);
+        thread = queue_remove(thread_done_q, tid);
+        if (thread == NULL) return ERROR;
+    }
+
+    if (status_ptr != NULL) *status_ptr = thread->exit_code;
+    delete_process(thread);
+    return SUCCESS;
+}
+
 /**
  * @brief 
  * 
@@ -131,98 +541,42 @@ int KernelExit(int exit_code, UserContext *uctxt) {
         return ERROR;
     }
 
+    // Exit from a thread ends just that thread
+    if (activePCB->thread_stack_pg > 0) {
+        return KernelThreadExit(exit_code, uctxt);
+    }
+
+    TracePrintf(0, "Ready -> %d ::: Blocked -> %d\n", ready_q->size, blocked_q->size);
 
-    TracePrintf(0, "Ready -> %d ::: Blocked -> %d ::: Defunct -> %d\n", ready_q->size, blocked_q->size, defunct_q->size);
+    // leave the process table and release anyone waiting on us for a message
+    IpcExit(activePCB);
+    bcast_exit(activePCB->pid);
     
     // update exit_code in PCB
     activePCB->exit_code = exit_code;
-    int limit;
-    queue_t *swap_q = NULL; // queue to swap process with
-    if (activePCB->ppid != 0 || activePCB->num_children > 0) {
-
-    // update parents && children in the ready queue
-        limit = ready_q->size;
-
-        // looping through ready queue
-        for (int i = 0; i < limit; i++) {
-            pcb_t *r_pcb = queue_pop(ready_q);
-
-            // if the pcb we popped is the child of our activePCB
-            if (r_pcb->ppid == activePCB->pid) {
-                // create orphan :(
-                r_pcb->ppid = 0;
-            } 
-            // if the pcb we popped is the parent of our active pcb
-            else if (r_pcb->pid == activePCB->ppid) {
-                // update the popped pcb's number of children
-                TracePrintf(0, "~~~ Children left -> %d children\n", r_pcb->num_children);
-                swap_q = defunct_q;
-            }
-            if (queue_add(ready_q, r_pcb, r_pcb->pid) == ERROR) {
-                TracePrintf(0,"ERROR: KernelExit, unable to add to queue in ready q for loop\n");
-                return ERROR;
-            }
-        }
-
-    // update parents && children in the blocked queue
-
-        limit = blocked_q->size;
-        // loop through the blocked queue
-        for (int i = 0; i < limit; i++) {
-            pcb_t *b_pcb = queue_pop(blocked_q);
-
-            // error checking
-            if (b_pcb == NULL) {
-                TracePrintf(0,"ERROR: KernelExit, b_pcb from queue is null.\n");
-                return ERROR;
-            }
-
-            // if the pcb we popped is the parent of our active process and it's blocked
-            if (b_pcb->pid == activePCB->ppid && b_pcb->blocked_code == BLOCKED_WAIT) {
-                // update exit code of active pcb
-                b_pcb->blocked_code = activePCB->exit_code;
-                b_pcb->num_children--;
-                TracePrintf(0, "~~~ Children left -> %d children\n", b_pcb->num_children);
-                if (queue_add(ready_q, b_pcb, b_pcb->pid) == ERROR) {
-                    TracePrintf(0,"ERROR: KernelExit, unable to add to queue in blocked q for loop\n");
-                    return ERROR;
-                }
-                continue;
-            } 
-            // if the pcb we popped is the parent and is not blocked
-            else if (b_pcb->pid == activePCB->ppid) {
-                TracePrintf(0, "~~~ Children left -> %d children\n", b_pcb->num_children);
-                swap_q = defunct_q;
-            } 
-            // if the pcb we popped is the child of the active process
-            else if (b_pcb->ppid == activePCB->pid) {
-                // make it an orphan
-                b_pcb->ppid = 0;
-            }
-            if (queue_add(blocked_q, b_pcb, b_pcb->pid) == ERROR) {
-                TracePrintf(0,"ERROR: KernelExit, unable to add to queue in blocked q for loop\n");
-                return ERROR;
-            }
-        }
+    ReleaseChildren(activePCB);
 
-        // if any children are in the defunct queue take them out
-        limit = defunct_q->size;
-        for (int i = 0; i < limit; i++) {
-            // for now only condition for defunct is if it has a ready/blocked parent
-            pcb_t *d_pcb = queue_pop(defunct_q);
-
-            if (d_pcb == NULL) {
-                TracePrintf(0,"ERROR: KernelExit, d_pcb from queue is null.\n");
-                return ERROR;
-            }
+    // our threads end with us, and the last of them frees the exited ones;
+    // if they're all gone already that's up to us
+    if (activePCB->as->users > 1) {
+        KillThreads(activePCB->tgid);
+    } else {
+        ReapThreads(activePCB->tgid);
+    }
 
-            if (d_pcb->ppid != activePCB->pid) {
-                if (queue_add(defunct_q, d_pcb, d_pcb->pid) == ERROR) {
-                    TracePrintf(0,"ERROR: KernelExit, unable to add to defunct queue.\n");
-                    return ERROR;
-                }
-            }
+    // a live parent keeps our exit code in its zombies queue until it Waits
+    // for it; wake it if it's waiting for us
+    pcb_t *parent = activePCB->ppid != 0 ? find_process(activePCB->ppid) : NULL;
+    queue_t *swap_q = NULL;
+    if (parent != NULL) {
+        swap_q = parent->zombies;
+        if (parent->blocked_code == BLOCKED_WAIT &&
+            (parent->wait_pid == WAIT_ANY || parent->wait_pid == activePCB->pid)) {
+            queue_remove(blocked_q, parent->pid);
+            parent->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, parent, parent->pid);
         }
+        PollWake(POLL_CHILD_EXIT);
     }
 
     // if nothing to swap
@@ -235,76 +589,96 @@ int KernelExit(int exit_code, UserContext *uctxt) {
     
     // otherwise
     else {
-         if (free_addr_space(activePCB->user_page_table, activePCB->kernel_stack_pt) == ERROR) {
+         if (drop_addr_space(activePCB) == ERROR) {
             TracePrintf(0,"ERROR: KernelExit, unable to delete process.\n");
             return ERROR;
         }
     }
 
+    // shared segments we were the last holder of can go now
+    shm_sweep();
+
     // then swap process
     if (SwapProcess(swap_q,uctxt) == ERROR) {
         TracePrintf(0, "ERROR: KernelExit, Unable to swap process.\n");
         return ERROR;
     }
-    TracePrintf(0, "Ready -> %d ::: Blocked -> %d ::: Defunct -> %d\n", ready_q->size, blocked_q->size, defunct_q->size);
+    TracePrintf(0, "Ready -> %d ::: Blocked -> %d\n", ready_q->size, blocked_q->size);
 
     return 0;
 }
 
 /**
- * @brief 
+ * @brief Waits for any child to exit
  * 
  * @param status_ptr 
- * @return int
+ * @return int the child's pid, ERROR if we have no children
  */
 int KernelWait(int *status_ptr, UserContext *uctxt) {
-    // check status_ptr and num of children, it shouldn't be null or 0
-    if (status_ptr == NULL || activePCB->num_children == 0) {
-        // *status_ptr = ERROR;
-        return ERROR;           // so calling wait with no children will just give ERROR
+    // check status_ptr, it shouldn't be null
+    if (status_ptr == NULL) {
+        return ERROR;
     }
+    return KernelWaitPid(WAIT_ANY, status_ptr, 0, uctxt);
+}
 
-    // check defunct queue
-    int limit = defunct_q->size;
-    for(int i = 0; i < limit; i++) {
-        // pop a queue out of defunct_q
-        pcb_t *d_pcb = queue_pop(defunct_q);
+/**
+ * @brief takes an exited child off pcb's zombies queue
+ * 
+ * @param pcb 
+ * @param pid child to take, WAIT_ANY for the oldest
+ * @return pcb_t* NULL if it hasn't exited
+ */
+static pcb_t *TakeZombie(pcb_t *pcb, int pid) {
+    if (pid == WAIT_ANY) return queue_pop(pcb->zombies);
+    return queue_remove(pcb->zombies, pid);
+}
 
-        if (d_pcb == NULL) {
-            TracePrintf(0, "ERROR: KernelWait, Unable to pop from queue.\n");
-            return ERROR;
-        }
+/**
+ * @brief Waits for child pid (or any child) to exit, then frees it. Each
+ * parent keeps its exited children in its own zombies queue, so this never
+ * looks at anyone else's.
+ * 
+ * @param pid child to wait for, WAIT_ANY for any
+ * @param status_ptr where to put its exit code, may be NULL
+ * @param flags WAIT_NOHANG to return WOULD_BLOCK instead of blocking
+ * @param uctxt 
+ * @return int the child's pid, WOULD_BLOCK, or ERROR if pid isn't our child
+ * (or we have no children at all, for WAIT_ANY)
+ */
+int KernelWaitPid(int pid, int *status_ptr, int flags, UserContext *uctxt) {
+    if (uctxt == NULL) {
+        TracePrintf(0,"ERROR: KernelWaitPid received a NULL argument\n");
+        return ERROR;
+    }
+    if (status_ptr != NULL && ValidUserRange(activePCB->user_page_table, status_ptr, sizeof(int), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+    if (pid == WAIT_ANY) {
+        if (activePCB->num_children == 0) return ERROR;
+    } else if (!queue_find(activePCB->zombies, pid)) {
+        pcb_t *child = find_process(pid);
+        if (child == NULL || child->ppid != activePCB->pid) return ERROR;
+    }
 
-        // if dead pcb is the child of active pcb
-        if (d_pcb->ppid == activePCB->pid) {
-            activePCB->num_children--;
-            *status_ptr = d_pcb->exit_code; // dead pcb still has exit code saved
-            return 0;
-        }
+    pcb_t *child;
+    while ((child = TakeZombie(activePCB, pid)) == NULL) {
+        if (flags & WAIT_NOHANG) return WOULD_BLOCK;
 
-        // add dead pcb back to defunct q
-        if(queue_add(defunct_q, d_pcb, d_pcb->pid) == ERROR) {
-            TracePrintf(0, "ERROR: KernelWait, unable to add to queue.\n");
+        // KernelExit of the child we want puts us back on the ready queue
+        activePCB->wait_pid = pid;
+        activePCB->blocked_code = BLOCKED_WAIT;
+        if (SwapProcess(blocked_q, uctxt) == ERROR) {
+            TracePrintf(0, "ERROR: KernelWaitPid, unable to swap process.\n");
             return ERROR;
         }
     }
-    // mark active process as blocked
-    activePCB->blocked_code = BLOCKED_WAIT;
-    //  save pid for when we come back
-    int set_code_pid = activePCB->pid;
-
-    // swap process
-    if (SwapProcess(blocked_q, uctxt) == ERROR) {
-        TracePrintf(0, "ERROR: KernelWait, unable to swap process.\n");
-        return ERROR;
-    }
 
-    // unblock once we swap back
-    if (activePCB->pid == set_code_pid) {
-        *status_ptr = activePCB->blocked_code;
-        activePCB->blocked_code = NOT_BLOCKED;
-    }
-    return 0;
+    activePCB->num_children--;
+    int child_pid = child->pid;
+    if (status_ptr != NULL) *status_ptr = child->exit_code;
+    delete_process(child);
+    return child_pid;
 }
 
 /**
@@ -409,6 +783,11 @@ int KernelBrk(void *addr) {
         }
     }
 
+    // threads share the heap with their process
+    for (lnode_t *node = process_list->head; node != NULL; node = node->next) {
+        pcb_t *pcb = (pcb_t *) node->data;
+        if (pcb->as == activePCB->as) pcb->user_heap_pt_index = target;
+    }
     activePCB->user_heap_pt_index = target;
     return 0;
 }
@@ -417,6 +796,74 @@ int KernelBrk(void *addr) {
 // =    I/O Syscalls 3.1.2      =
 // ==============================
 
+// plain and vectored tty/pipe calls share these, the plain ones pass a single segment
+static int TtyWriteIov(UserContext *uctxt, int tty_id, io_vec_t *iov, int len);
+static int PipeReadIov(int pipe_id, io_vec_t *iov, int len, int timeout, UserContext *uctxt);
+static int PipeWriteIov(int pipe_id, io_vec_t *iov, int len, int whole, UserContext *uctxt);
+static void SplicePump(pipe_t *pipe);
+static void SpliceRefill(int pipe_id);
+
+/**
+ * @brief checks a user array of segments and every segment in it
+ * 
+ * @param iov 
+ * @param iovcnt 
+ * @param prot access the segments need, PROT_READ or PROT_WRITE
+ * @return int total length of the segments, ERROR if any is invalid
+ */
+static int IovLength(io_vec_t *iov, int iovcnt, int prot) {
+    if (iovcnt <= 0 || iovcnt > MAX_IOV ||
+        ValidUserRange(activePCB->user_page_table, iov, iovcnt * sizeof(io_vec_t), PROT_READ) == ERROR) {
+        return ERROR;
+    }
+    int total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].len < 0 || ValidUserRange(activePCB->user_page_table, iov[i].base, iov[i].len, prot) == ERROR) {
+            return ERROR;
+        }
+        total += iov[i].len;
+    }
+    return total;
+}
+
+/**
+ * @brief copies len bytes out of the segments into dst, starting offset
+ * bytes into them
+ * 
+ * @param dst 
+ * @param iov 
+ * @param offset 
+ * @param len 
+ */
+static void IovGather(char *dst, io_vec_t *iov, int offset, int len) {
+    for (; offset >= iov->len && len > 0; iov++) offset -= iov->len;
+    while (len > 0) {
+        int n = iov->len - offset;
+        if (n > len) n = len;
+        memcpy(dst, (char *) iov->base + offset, n);
+        dst += n;
+        len -= n;
+        offset = 0;
+        iov++;
+    }
+}
+
+/**
+ * @brief copies len bytes from src into the segments, filling each in turn
+ * 
+ * @param iov 
+ * @param src 
+ * @param len 
+ */
+static void IovScatter(io_vec_t *iov, char *src, int len) {
+    for (; len > 0; iov++) {
+        int n = iov->len < len ? iov->len : len;
+        memcpy(iov->base, src, n);
+        src += n;
+        len -= n;
+    }
+}
+
 /**
  * @brief 
  * 
@@ -434,88 +881,63 @@ int KernelDelay(int clock_ticks, UserContext *uctxt) {
 
     // delay assumes that the idle process will never be blocked ensuring that we always have an available proccess
 
-    // some bookkeeping
-    activePCB->clock_ticks = clock_ticks;
+    // the timer readies us at the deadline, nothing else looks at us meanwhile
     activePCB->blocked_code = BLOCKED_DELAY;
+    timer_arm(activePCB, blocked_q, global_clock_ticks + clock_ticks);
 
     // swap process
     if (SwapProcess(blocked_q,uctxt) == ERROR) {
         TracePrintf(0, "ERROR: KernelDelay, unable to swap processes.\n");
         return ERROR;
     }
+    timer_cancel(activePCB);
 
     return 0; 
 
 }
 
 /**
- * @brief 
+ * @brief reads a line (or in raw mode everything buffered) from the
+ * terminal, waiting behind earlier readers and then for input
  * 
  * @param uctxt
  * @param tty_id 
  * @param buf 
  * @param len 
- * @return int 
+ * @param timeout ticks to wait, 0 to not wait, -1 to wait forever
+ * @return int bytes read, 0 if timeout is 0 and there's nothing to read,
+ * TIMED_OUT or ERROR
  */
-int KernelTtyRead(UserContext *uctxt, int tty_id, void *buf, int len) {
-    char *ttyBuffer = ttyReadbuffers[tty_id];
-    queue_t *ttyQueue = ttyReadQueues[tty_id];
-
-    if (ttyQueue == NULL || ttyBuffer == NULL) {
-        // some error stuff
-        return ERROR;
-    } else if (len < 0) {
-        // some error stuff
-        return ERROR;
-    }
-    else if ((tty_id < 0) || (tty_id > 3)){
+static int TtyReadFor(UserContext *uctxt, int tty_id, void *buf, int len, int timeout) {
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS || len < 0 ||
+        ValidUserRange(activePCB->user_page_table, buf, len, PROT_WRITE) == ERROR) {
         return ERROR;
-    
     } else if (len == 0) return 0; // nothing to read
+    queue_t *ttyQueue = ttyReadQueues[tty_id];
 
-    // verify that there are no processes waiting to read from the terminal and there is input to read
-    if (ttyQueue->size > 0 || ttyBuffer[0] == 0) {
+    // wait behind earlier readers, then until there's input for us
+    int must_wait = ttyQueue->size > 0 || tty_input_ready(tty_id) == 0;
+    if (must_wait && timeout == 0) return 0;
+    int give_up = global_clock_ticks + timeout;
+    while (must_wait) {
         activePCB->blocked_code = BLOCKED_TTY_READ;
         activePCB->tty_terminal = tty_id;
+        if (timeout > 0) timer_arm(activePCB, ttyQueue, give_up);
         SwapProcess(ttyQueue, uctxt);
-    }
-
-    int bytes_num;
-
-    // looping up until the first new line   
-    for(bytes_num = 0; bytes_num < ttyReadTrackers[tty_id]; bytes_num++) {
-
-        // if we see a new line
-        if(ttyBuffer[bytes_num] == '\n') {
-            bytes_num++;
-            break;
+        if (timeout > 0) {
+            timer_cancel(activePCB);
+            if (activePCB->timed_out) return TIMED_OUT;
         }
+        must_wait = tty_input_ready(tty_id) == 0;
     }
 
-    if (bytes_num > len) {
-        bytes_num = len;
-    }
-
-    //copy the bytes  (as many as possible) into buf
-    memcpy(buf, ttyBuffer, bytes_num);
-
-    // temporary buffer to use to move the bytes up
-    char tempBuffer[ttyReadTrackers[tty_id] - bytes_num];
-
-    // save the remaining bytes in terminal buffer to a temporary buffer
-    memcpy(tempBuffer, &(ttyBuffer[bytes_num]), ttyReadTrackers[tty_id] - bytes_num);
-
-    // clear the tty buffer for the terminal
-    memset(ttyBuffer, 0, ttyReadTrackers[tty_id]);
-
-    // move the save bytes bytes to the terminal buffer
-    memcpy(ttyBuffer, tempBuffer, ttyReadTrackers[tty_id] - bytes_num);
-    ttyReadTrackers[tty_id] = ttyReadTrackers[tty_id] - bytes_num;
-    TracePrintf(0, "KernelTtyRead LOG: track %d\n", ttyReadTrackers[tty_id]);
+    // a line (or in raw mode everything) straight out of the ring
+    int bytes_num = tty_input_take(tty_id, buf, len);
+    TracePrintf(0, "KernelTtyRead LOG: read %d, %d more ready\n", bytes_num, tty_input_ready(tty_id));
 
     // move next reader (if any) to the ready queue
-    if (ttyQueue->size > 0 && ttyBuffer[0] != 0) {
-        pcb_t *nextReader = queue_peek(ttyQueue);
+    if (ttyQueue->size > 0 && tty_input_ready(tty_id) > 0) {
+        pcb_t *nextReader = queue_pop(ttyQueue);
         nextReader->blocked_code = NOT_BLOCKED;
         queue_add(ready_q, nextReader, nextReader->pid);
     }
@@ -532,84 +954,224 @@ int KernelTtyRead(UserContext *uctxt, int tty_id, void *buf, int len) {
  * @param len 
  * @return int 
  */
-int KernelTtyWrite(UserContext *uctxt, int tty_id, void *buf, int len) {
-    
-    // have a queue for processes waiting to write
-    queue_t *ttyQueue = ttyWriteQueues[tty_id];
+int KernelTtyRead(UserContext *uctxt, int tty_id, void *buf, int len) {
+    return TtyReadFor(uctxt, tty_id, buf, len, -1);
+}
+
+/**
+ * @brief Reads from the terminal without waiting (ticks 0) or waiting at
+ * most ticks clock ticks for input
+ * 
+ * @param uctxt 
+ * @param tty_id 
+ * @param buf 
+ * @param len 
+ * @param ticks 
+ * @return int bytes read, 0 if ticks is 0 and there's nothing to read,
+ * TIMED_OUT or ERROR
+ */
+int KernelTtyReadTimeout(UserContext *uctxt, int tty_id, void *buf, int len, int ticks) {
+    if (ticks < 0) return ERROR;
+    return TtyReadFor(uctxt, tty_id, buf, len, ticks);
+}
+
+/**
+ * @brief Switches a terminal between cooked and raw input, and resizes its
+ * input buffer unless capacity is 0
+ * 
+ * @param tty_id 
+ * @param mode TTY_COOKED or TTY_RAW
+ * @param capacity 
+ * @return int 
+ */
+int KernelTtySetMode(int tty_id, int mode, int capacity) {
+    if (tty_set_mode(tty_id, mode, capacity) == ERROR) return ERROR;
+
+    // raw mode may have made buffered input readable
+    if (tty_input_ready(tty_id) > 0 && ttyReadQueues[tty_id]->size > 0) {
+        pcb_t *nextReader = queue_pop(ttyReadQueues[tty_id]);
+        nextReader->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, nextReader, nextReader->pid);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Copies out the caller's TtyWrite counters for a terminal
+ * 
+ * @param tty_id 
+ * @param statsp 
+ * @return int 
+ */
+int KernelTtyWriteStats(int tty_id, tty_write_stats_t *statsp) {
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS ||
+        ValidUserRange(activePCB->user_page_table, statsp, sizeof(tty_write_stats_t), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+    *statsp = activePCB->tty_stats[tty_id];
+    return SUCCESS;
+}
+
+/**
+ * @brief 
+ * 
+ * @param uctxt
+ * @param tty_id 
+ * @param buf 
+ * @param len 
+ * @return int 
+ */
+int KernelTtyWrite(UserContext *uctxt, int tty_id, void *buf, int len) {
 	
 	// error checking
-    if (ttyQueue == NULL) {
-        // some error stuff
-        return ERROR;
-    } 
-    else if ((tty_id < 0) || (tty_id > 3)){
+    if ((tty_id < 0) || (tty_id > 3)){
         return ERROR;
     }
-    else if (len < 0) {
+    else if (len < 0 || ValidUserRange(activePCB->user_page_table, buf, len, PROT_READ) == ERROR) {
         // some error stuff
         return ERROR;
     } else if (len == 0) return 0; // nothing to write
-	
-	// add calling prrocess
-    queue_add(ttyQueue, activePCB, activePCB->pid);
 
-    // verify that there are no processes waiting to write to the terminal and there is output to write
-    if (queue_peek(ttyQueue)->pid != activePCB->pid) {
-        activePCB->blocked_code = BLOCKED_TTY_WRITE;
-        activePCB->tty_terminal = tty_id;
-        
-        // swapping process while keeping the current process at the top of its queue, because it has more writing to do. This is to prevent another process from writing to the the same terminal before this process is done
-        SwapProcess(NULL, uctxt);
+    io_vec_t iov = { buf, len };
+    return TtyWriteIov(uctxt, tty_id, &iov, len);
+}
+
+/**
+ * @brief Writes the segments of iov to the terminal as one write: its
+ * lines can interleave with other writers' lines, but never split
+ * 
+ * @param uctxt 
+ * @param tty_id 
+ * @param iov 
+ * @param iovcnt 
+ * @return int bytes written, ERROR otherwise
+ */
+int KernelTtyWritev(UserContext *uctxt, int tty_id, io_vec_t *iov, int iovcnt) {
+    if ((tty_id < 0) || (tty_id >= NUM_TERMINALS)) {
+        return ERROR;
+    }
+    int len = IovLength(iov, iovcnt, PROT_READ);
+    if (len == ERROR) {
+        TracePrintf(0, "ERROR: KernelTtyWritev, invalid segments\n");
+        return ERROR;
+    } else if (len == 0) return 0;
+
+    return TtyWriteIov(uctxt, tty_id, iov, len);
+}
+
+/**
+ * @brief length of the next turn's worth of a write: up to and including
+ * the next newline, at most TERMINAL_MAX_LINE bytes
+ * 
+ * @param iov 
+ * @param seg segment the write has got to
+ * @param seg_off offset into that segment
+ * @param left bytes of the write still to go
+ * @return int 
+ */
+static int TtyChunkLength(io_vec_t *iov, int seg, int seg_off, int left) {
+    int max = left < TERMINAL_MAX_LINE ? left : TERMINAL_MAX_LINE;
+    int n = 0;
+    while (n < max) {
+        if (seg_off == iov[seg].len) {
+            seg++;
+            seg_off = 0;
+            continue;
+        }
+        n++;
+        if (((char *) iov[seg].base)[seg_off++] == '\n') break;
+    }
+    return n;
+}
+
+/**
+ * @brief readies the writer at the head of a terminal's write queue if it's
+ * waiting for its turn or for room
+ * 
+ * @param tty_id 
+ */
+static void TtyWakeWriter(int tty_id) {
+    pcb_t *writer = queue_peek(ttyWriteQueues[tty_id]);
+    if (writer != NULL && writer->blocked_code == BLOCKED_TTY_WRITE) {
+        writer->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, writer, writer->pid);
     }
+}
+
+/**
+ * @brief queues len bytes gathered from iov for the terminal and returns
+ * without waiting for them to go out. Writers take turns at the head of
+ * the terminal's write queue: each turn puts one line into the output
+ * ring, then the writer goes to the back if anyone else is waiting. A
+ * writer only blocks for its turn, or while the ring can't take its line.
+ * 
+ * @param uctxt 
+ * @param tty_id 
+ * @param iov 
+ * @param len 
+ * @return int bytes written
+ */
+static int TtyWriteIov(UserContext *uctxt, int tty_id, io_vec_t *iov, int len) {
+    
+    // have a queue for processes waiting to write
+    queue_t *ttyQueue = ttyWriteQueues[tty_id];
+    tty_write_stats_t *stats = &activePCB->tty_stats[tty_id];
+
+	// add calling prrocess
+    queue_add(ttyQueue, activePCB, activePCB->pid);
     
-    int bytes_left = len;
     int bytes_written = 0;
+    int seg = 0;
+    int seg_off = 0;
     
     // while there's more to write
-    while (bytes_left > 0) {
-    
-    	// while the terminal is taken
-        while (ttyWriteTrackers[tty_id] == TERMINAL_CLOSED) {
-        
-        	// mark the current process as blocked
-            activePCB->blocked_code = BLOCKED_TTY_TRANSMIT;
-            activePCB->tty_terminal = tty_id;
-            
-            // swap process without putting anyone else in front, so we're still in front of the queue
-            SwapProcess(NULL, uctxt);
+    while (bytes_written < len) {
+        int chunk = TtyChunkLength(iov, seg, seg_off, len - bytes_written);
+
+        // wait for our turn and for room for the whole line; whoever
+        // leaves the head, or the transmit interrupt, wakes us
+        if (queue_peek(ttyQueue)->pid != activePCB->pid || tty_output_room(tty_id) < chunk) {
+            int start = global_clock_ticks;
+            stats->waits++;
+            while (queue_peek(ttyQueue)->pid != activePCB->pid || tty_output_room(tty_id) < chunk) {
+                activePCB->blocked_code = BLOCKED_TTY_WRITE;
+                activePCB->tty_terminal = tty_id;
+                SwapProcess(NULL, uctxt);
+            }
+            stats->wait_ticks += global_clock_ticks - start;
         }
-        
-        // mark the terminal as taken
-        ttyWriteTrackers[tty_id] = TERMINAL_CLOSED;
 
-        int to_write;
-
-        if (bytes_left > TERMINAL_MAX_LINE) {
-            to_write = TERMINAL_MAX_LINE;
-        } else {
-            to_write = bytes_left;
+        // copy the line into the output ring, it can span segments
+        for (int copied = 0; copied < chunk; ) {
+            if (seg_off == iov[seg].len) {
+                seg++;
+                seg_off = 0;
+                continue;
+            }
+            int n = iov[seg].len - seg_off;
+            if (n > chunk - copied) n = chunk - copied;
+            tty_output_put(tty_id, (char *) iov[seg].base + seg_off, n);
+            seg_off += n;
+            copied += n;
+        }
+        bytes_written += chunk;
+        stats->bytes += chunk;
+        tty_output_start(tty_id);
+
+        // round robin: let the next writer have a line before our next one
+        if (bytes_written < len && ttyQueue->size > 1) {
+            queue_remove(ttyQueue, activePCB->pid);
+            queue_add(ttyQueue, activePCB, activePCB->pid);
+            TtyWakeWriter(tty_id);
         }
-        
-        // buffer to write to
-        char *ttyBuffer[to_write];
-        
-        // copy truncated info bytes to buffer
-        memcpy(ttyBuffer, buf + bytes_written, to_write);
-        
-   		// ttytransmit
-        TtyTransmit(tty_id, ttyBuffer, to_write);
-        
-        // update how much we've written and how much there is left to write
-        bytes_left -= to_write;
-        bytes_written += to_write;
     }
 
 	// wake up anyone waiting to write to the same terminal
-    queue_pop(ttyQueue);
+    queue_remove(ttyQueue, activePCB->pid);
     if (ttyQueue->size > 0) {
-        pcb_t *nextWriter = queue_peek(ttyQueue);
-        nextWriter->blocked_code = NOT_BLOCKED;
-        queue_add(ready_q, nextWriter, nextWriter->pid);
+        TtyWakeWriter(tty_id);
+    } else if (tty_output_room(tty_id) > 0) {
+        PollWake(POLL_TTY_WRITE);
     }
 
     return bytes_written;
@@ -619,6 +1181,25 @@ int KernelTtyWrite(UserContext *uctxt, int tty_id, void *buf, int len) {
 // =    InterProcess Communication (IPC) 3.1.3    =
 // ================================================
 
+/**
+ * @brief wakes the first reader blocked on the pipe that the bytes now in it
+ * satisfy. Readers wake one at a time; each passes the leftovers on when
+ * it's done.
+ * 
+ * @param pipe 
+ */
+static void PipeWakeReader(pipe_t *pipe) {
+    for (qnode_t *node = pipe->queue->head; node != NULL; node = node->next) {
+        pcb_t *reader = node->data;
+        if (pipe->plen >= reader->pipe_need) {
+            queue_remove(pipe->queue, reader->pid);
+            reader->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, reader, reader->pid);
+            return;
+        }
+    }
+}
+
 /**
  * @brief 
  * 
@@ -652,15 +1233,16 @@ int KernelPipeInit(int *pipe_idp) {
 }
 
 /**
- * @brief 
+ * @brief checks a plain read buffer and reads into it
  * 
  * @param pipe_id 
  * @param buf 
  * @param len 
+ * @param timeout ticks to wait for data, -1 to wait forever
  * @param uctxt
- * @return int 
+ * @return int bytes read, TIMED_OUT or ERROR
  */
-int KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uctxt) {
+static int PipeReadBuf(int pipe_id, void *buf, int len, int timeout, UserContext *uctxt) {
     TracePrintf(0,"Entered KernelPipeRead...\n");
     // check arguments are valid (no negatives or nulls)
         // error if anything invalid
@@ -673,40 +1255,108 @@ int KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uctxt) {
         return ERROR;
     }
 
+    io_vec_t iov = { buf, len };
+    return PipeReadIov(pipe_id, &iov, len, timeout, uctxt);
+}
+
+/**
+ * @brief 
+ * 
+ * @param pipe_id 
+ * @param buf 
+ * @param len 
+ * @param uctxt
+ * @return int 
+ */
+int KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uctxt) {
+    return PipeReadBuf(pipe_id, buf, len, -1, uctxt);
+}
+
+/**
+ * @brief Reads from the pipe, giving up if it stays empty for ticks clock ticks
+ * 
+ * @param pipe_id 
+ * @param buf 
+ * @param len 
+ * @param ticks 
+ * @param uctxt 
+ * @return int bytes read, TIMED_OUT or ERROR
+ */
+int KernelPipeReadTimeout(int pipe_id, void *buf, int len, int ticks, UserContext *uctxt) {
+    if (ticks < 0) return ERROR;
+    return PipeReadBuf(pipe_id, buf, len, ticks, uctxt);
+}
+
+/**
+ * @brief Reads from the pipe into the segments of iov, filling each in turn
+ * 
+ * @param pipe_id 
+ * @param iov 
+ * @param iovcnt 
+ * @param uctxt 
+ * @return int bytes read, ERROR otherwise
+ */
+int KernelPipeReadv(int pipe_id, io_vec_t *iov, int iovcnt, UserContext *uctxt) {
+    int len = IovLength(iov, iovcnt, PROT_WRITE);
+    if (len == ERROR || len > PIPE_BUFFER_LEN) {
+        TracePrintf(0, "ERROR: KernelPipeReadv, invalid segments\n");
+        return ERROR;
+    }
+    return PipeReadIov(pipe_id, iov, len, -1, uctxt);
+}
 
+/**
+ * @brief reads up to len bytes from the pipe, scattered over iov
+ * 
+ * @param pipe_id 
+ * @param iov 
+ * @param len 
+ * @param timeout ticks to wait for data, -1 to wait forever
+ * @param uctxt 
+ * @return int bytes read, TIMED_OUT if the pipe stayed empty, ERROR otherwise
+ */
+static int PipeReadIov(int pipe_id, io_vec_t *iov, int len, int timeout, UserContext *uctxt) {
 
     // check ids of pipes, get the matchcing pipe
+    // the head of the pipe list isn't a pipe anyone can use
     pipe_t* curr_pipe = get_pipe(head_pipe,pipe_id);
-    if (curr_pipe == NULL) {
+    if (curr_pipe == NULL || pipe_id == PIPE_ID_BASE) {
         TracePrintf(0,"ERROR: KernelPipeRead, get_pipe failed\n");
         return ERROR;
     }
 
-    // if current pipe is taken
-    if (curr_pipe->being_used == PIPE_NOT_FREE) {
-        TracePrintf(0,"KernelPipeRead: detected that pipe %d is busy right now!\n",curr_pipe->id);
-
-        // enter waiting queue
-        activePCB->blocked_code = BLOCKED_PIPE_READ;
-        queue_add(curr_pipe->queue,activePCB,activePCB->pid);
-
-        // swap process
-        SwapProcess(blocked_q,uctxt);
-    }
-    
-    
-    // block readers while pipe is empty
-    while (curr_pipe->plen == 0) {
-    // block caller
-        TracePrintf(0,"KernelPipeRead: detected that pipe %d is empty right now!\n",curr_pipe->id);
+    // block until the pipe holds enough to be worth a read: its low
+    // watermark (capped at what we can take), or any byte at all once the
+    // watermark deadline has passed
+    int need = curr_pipe->lowat < len ? curr_pipe->lowat : len;
+    if (need < 1) need = 1;
+    int deadline = global_clock_ticks + curr_pipe->lowat_ticks;
+    int give_up = global_clock_ticks + timeout;
+    while (curr_pipe->plen < need) {
+        // out of time: settle for whatever the pipe holds
+        if (timeout >= 0 && global_clock_ticks >= give_up) {
+            if (curr_pipe->plen == 0) return TIMED_OUT;
+            break;
+        }
+        TracePrintf(0,"KernelPipeRead: pipe %d has %d of %d bytes, blocking\n",curr_pipe->id,curr_pipe->plen,need);
 
         // book keeping
         activePCB->blocked_code = BLOCKED_PIPE_READ;
-        queue_add(curr_pipe->queue,activePCB,activePCB->pid);
-
-        // swap to blocked queue
-        SwapProcess(blocked_q,uctxt);
+        activePCB->pipe_need = need;
+        int lowat_timed = need > 1 && curr_pipe->lowat_ticks > 0;
+        int timed = lowat_timed || timeout >= 0;
+        if (timed) {
+            int wake_at = lowat_timed ? deadline : give_up;
+            if (timeout >= 0 && give_up < wake_at) wake_at = give_up;
+            timer_arm(activePCB, curr_pipe->queue, wake_at);
+        }
 
+        // wait in the pipe's queue for a writer (or the timer) to wake us
+        SwapProcess(curr_pipe->queue,uctxt);
+        if (timed) {
+            timer_cancel(activePCB);
+            if (lowat_timed && global_clock_ticks >= deadline) need = 1;
+        }
     }
 
     // mark pipe as taken
@@ -719,7 +1369,7 @@ int KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uctxt) {
     if (curr_pipe->plen > len) {
 
         // put len data in buf
-        memcpy(buf,curr_pipe->buf,len);
+        IovScatter(iov, curr_pipe->buf, len);
         
         // remove len data from pipe
         for (int i = 0; i < curr_pipe->plen - len ; i++) {
@@ -736,7 +1386,7 @@ int KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uctxt) {
     else { 
 
         // put plen data in buf
-        memcpy(buf,curr_pipe->buf,curr_pipe->plen);
+        IovScatter(iov, curr_pipe->buf, curr_pipe->plen);
         // remove plen data from pipeone
         memset(curr_pipe->buf,0,curr_pipe->plen);
         // update length of pipe
@@ -748,73 +1398,16 @@ int KernelPipeRead(int pipe_id, void *buf, int len, UserContext *uctxt) {
     }
         
     
-    // if there's stuff to be read, wake up the first process in line
-    if (curr_pipe->plen > 0) {
-
-        // if there are process waiting
-        if (curr_pipe->queue->size > 0) {
-            pcb_t* process_to_wake = queue_pop(curr_pipe->queue);
-
-            // update bookkeeping
-            process_to_wake->blocked_code = NOT_BLOCKED;
-
-            // remove from blocked_q
-            for (int i = 0; i < blocked_q->size; i++) {
-                // pop process off blocked queue
-                pcb_t* curr_pcb = queue_pop(blocked_q);
-
-                // if it's our desired process, break, otherwise add it back to queue
-                if (curr_pcb->pid = process_to_wake->pid) {
-                    break;
-                }
-                else {
-                    queue_add(blocked_q,curr_pcb,curr_pcb->pid);
-                }
-            }
-            // add to ready_q   
-            queue_add(ready_q,process_to_wake,process_to_wake->pid);
-        }
-    }
-
-    // if there's nothing to be read, wake up writers only
-    else {
-        
-        // looping through the queue of processes waiting to read/write
-        for (int i =0; i < curr_pipe->queue->size; i++) {
-            pcb_t* process_to_wake = queue_pop(curr_pipe->queue);
-
-            // if they're waiting to write, wake them up!
-            if (process_to_wake->blocked_code = BLOCKED_PIPE_WRITE) {
-
-                // update bookkeeping
-                process_to_wake->blocked_code = NOT_BLOCKED;
-
-                    // remove from blocked_q
-                for (int i = 0; i < blocked_q->size; i++) {
-                    // pop process off blocked queue
-                    pcb_t* curr_pcb = queue_pop(blocked_q);
-
-                    // if it's our desired process, we're good, otherwise add it back to queue
-                    if (curr_pcb->pid = process_to_wake->pid) {
-                        queue_add(ready_q,curr_pcb,curr_pcb->pid);
-                        break;
-                    }
-                    else {
-                        queue_add(blocked_q,curr_pcb,curr_pcb->pid);
-                    }
-                }
-                // break out, we're waking up only 1 
-                break;
-            } else {
-                // otherwise add it back to queue
-                queue_add(blocked_q,process_to_wake,process_to_wake->pid);
-            }
-        }
-    }
+    // whatever is left may be enough for the next reader
+    PipeWakeReader(curr_pipe);
 
     // pipe no longer taken
     TracePrintf(0,"KernelPipeRead: Freeing pipe...\n");
     curr_pipe->being_used = PIPE_FREE;
+    if (amount_read > 0) {
+        PollWake(POLL_PIPE_WRITE);
+        SpliceRefill(curr_pipe->id);
+    }
     return amount_read;
 }
 
@@ -842,91 +1435,291 @@ int KernelPipeWrite(int pipe_id, void *buf, int len, UserContext *uctxt) {
         return ERROR;
     }
 
-    // check ids of pipes
-    // if id matches
-    pipe_t* curr_pipe = get_pipe(head_pipe,pipe_id);
+    io_vec_t iov = { buf, len };
+    return PipeWriteIov(pipe_id, &iov, len, 0, uctxt);
+}
 
-    if (curr_pipe == NULL) {
-        TracePrintf(0,"ERROR: KernelPipeWrite, get_pipe failed\n");
+/**
+ * @brief Sets how many bytes readers of the pipe wait for, and for how long.
+ * Blocked readers pick the new values up on their next read.
+ * 
+ * @param pipe_id 
+ * @param min_bytes 
+ * @param ticks 0 to wait for min_bytes however long it takes
+ * @return int 
+ */
+int KernelPipeSetLowat(int pipe_id, int min_bytes, int ticks) {
+    pipe_t *curr_pipe = get_pipe(head_pipe, pipe_id);
+    if (curr_pipe == NULL || pipe_id == PIPE_ID_BASE || min_bytes < 1 || min_bytes > PIPE_BUFFER_LEN || ticks < 0) {
+        TracePrintf(0, "ERROR: KernelPipeSetLowat, invalid arguments\n");
+        return ERROR;
     }
+    curr_pipe->lowat = min_bytes;
+    curr_pipe->lowat_ticks = ticks;
+    return 0;
+}
 
-    // if current pipe is taken
-    while (curr_pipe->being_used == PIPE_NOT_FREE) {
-
-        TracePrintf(0,"KernelPipeWrite: detected that pipe %d is busy right now!\n",curr_pipe->id);
-
-        // enter waiting queue
-        activePCB->blocked_code = BLOCKED_PIPE_WRITE;
-        queue_add(curr_pipe->queue,activePCB,activePCB->pid);
+/**
+ * @brief drops the first n bytes of the pipe
+ * 
+ * @param pipe 
+ * @param n 
+ */
+static void PipeConsume(pipe_t *pipe, int n) {
+    memmove(pipe->buf, pipe->buf + n, pipe->plen - n);
+    pipe->plen -= n;
+}
 
-        // swap process
-        SwapProcess(blocked_q,uctxt);
+/**
+ * @brief moves as much of a spliced pipe's contents as its destination
+ * takes right now: into another pipe (and on down that pipe's splice), or
+ * into a terminal's output ring, whose transmit interrupt asks for more
+ * 
+ * @param pipe 
+ */
+static void SplicePump(pipe_t *pipe) {
+    if (pipe == NULL || pipe->splice_to == NO_SPLICE || pipe->plen == 0) return;
+
+    int n;
+    if (pipe->splice_to < NUM_TERMINALS) {
+        int tty_id = pipe->splice_to;
+        // processes writing to the terminal go first
+        if (ttyWriteQueues[tty_id]->size > 0) return;
+        n = tty_output_put(tty_id, pipe->buf, pipe->plen);
+        if (n == 0) return;
+        tty_output_start(tty_id);
+        PipeConsume(pipe, n);
+    } else {
+        pipe_t *dest = get_pipe(head_pipe, pipe->splice_to);
+        if (dest == NULL) return;
+        n = PIPE_BUFFER_LEN - dest->plen;
+        if (n > pipe->plen) n = pipe->plen;
+        if (n == 0) return;
+        memcpy(dest->buf + dest->plen, pipe->buf, n);
+        dest->plen += n;
+        PipeConsume(pipe, n);
+        SplicePump(dest);
+        PipeWakeReader(dest);
+        PollWake(POLL_PIPE_READ);
     }
+    PollWake(POLL_PIPE_WRITE);
+}
 
-    // mark pipe is being used
-    curr_pipe->being_used = PIPE_NOT_FREE;
-    TracePrintf(0,"KernelPipeWrite: marking pipe as taken...\n");
-
-
-    // int available space = max pipe length - plen
-    int available_space = PIPE_BUFFER_LEN - curr_pipe->plen;
-    int amount_written;
+/**
+ * @brief pumps every pipe spliced into pipe_id, which just got room
+ * 
+ * @param pipe_id 
+ */
+static void SpliceRefill(int pipe_id) {
+    for (pipe_t *pipe = head_pipe->next; pipe != NULL; pipe = pipe->next) {
+        if (pipe->splice_to == pipe_id) SplicePump(pipe);
+    }
+}
 
-    // if available space >= len, so if there's enough space to put all the stuff in
-    if (available_space >= len) {
-        // put len data from buf into pipe
-        memcpy(curr_pipe->buf + curr_pipe->plen,buf,len);
-        TracePrintf(0,"Wrote %d many bytes of \"%s\"\n",len,buf);
-        // update length of pipe
-        curr_pipe->plen = curr_pipe->plen + len;
+/**
+ * @brief Called when a terminal finishes a transmission and no process is
+ * waiting to write to it: queues more of its spliced pipe, if any
+ * 
+ * @param tty_id 
+ */
+void SpliceTtyReady(int tty_id) {
+    if (ttySplicePipes[tty_id] == NO_SPLICE) return;
+    pipe_t *pipe = get_pipe(head_pipe, ttySplicePipes[tty_id]);
+    SplicePump(pipe);
+    if (pipe != NULL) SpliceRefill(pipe->id);
+}
 
-        amount_written = len;
+/**
+ * @brief Connects the pipe's output to a terminal (0 to NUM_TERMINALS - 1)
+ * or another pipe. From then on the kernel moves the bytes written to it
+ * as they arrive, without any process reading them. NO_SPLICE undoes it.
+ * 
+ * @param pipe_id 
+ * @param dest_id 
+ * @return int 
+ */
+int KernelSplice(int pipe_id, int dest_id) {
+    pipe_t *pipe = get_pipe(head_pipe, pipe_id);
+    if (pipe == NULL || pipe_id == PIPE_ID_BASE) {
+        TracePrintf(0, "ERROR: KernelSplice, no pipe %d\n", pipe_id);
+        return ERROR;
     }
 
+    // undo the old connection first
+    if (pipe->splice_to >= 0 && pipe->splice_to < NUM_TERMINALS) {
+        ttySplicePipes[pipe->splice_to] = NO_SPLICE;
+    }
+    pipe->splice_to = NO_SPLICE;
+    if (dest_id == NO_SPLICE) return 0;
 
-    // else if available space < len
-    else {
-        // put available space amount of data from buf into pipe
-        memcpy(curr_pipe->buf + curr_pipe->plen,buf,available_space);
-        
-        // update length of pipe
-        curr_pipe->plen = curr_pipe->plen + available_space;
-
-        amount_written = available_space;
+    if (dest_id >= 0 && dest_id < NUM_TERMINALS) {
+        if (ttySplicePipes[dest_id] != NO_SPLICE) {
+            TracePrintf(0, "ERROR: KernelSplice, terminal %d already has a spliced pipe\n", dest_id);
+            return ERROR;
+        }
+        ttySplicePipes[dest_id] = pipe_id;
+    } else {
+        if (dest_id == PIPE_ID_BASE || get_pipe(head_pipe, dest_id) == NULL) {
+            TracePrintf(0, "ERROR: KernelSplice, no destination %d\n", dest_id);
+            return ERROR;
+        }
+        // following the destination's splices must not lead back here
+        for (int id = dest_id; id >= NUM_TERMINALS; id = get_pipe(head_pipe, id)->splice_to) {
+            if (id == pipe_id) {
+                TracePrintf(0, "ERROR: KernelSplice, splicing %d to %d makes a loop\n", pipe_id, dest_id);
+                return ERROR;
+            }
+        }
     }
-    
-    // broadcast: signal all readers and writers
-    // if we signal only one, we risk processes never waking up when they should
+    pipe->splice_to = dest_id;
 
-    TracePrintf(0,"Current queue to read/write pipe %d is %d\n",curr_pipe->id,curr_pipe->queue->size);
+    // move whatever was already waiting
+    SplicePump(pipe);
+    return 0;
+}
 
-    if (curr_pipe->queue->size > 0) {
-        // looping through the queue of processes waiting to read/write
-        for (int i =0; i < curr_pipe->queue->size; i++) {
-            pcb_t* process_to_wake = queue_pop(curr_pipe->queue);
+/**
+ * @brief Makes every byte written to the pipe also go into copy_id, while
+ * the pipe's own readers (or splice) still get it. NO_SPLICE undoes it.
+ * 
+ * @param pipe_id 
+ * @param copy_id 
+ * @return int 
+ */
+int KernelTee(int pipe_id, int copy_id) {
+    pipe_t *pipe = get_pipe(head_pipe, pipe_id);
+    if (pipe == NULL || pipe_id == PIPE_ID_BASE) {
+        TracePrintf(0, "ERROR: KernelTee, no pipe %d\n", pipe_id);
+        return ERROR;
+    }
+    if (copy_id != NO_SPLICE &&
+        (copy_id == pipe_id || copy_id == PIPE_ID_BASE || get_pipe(head_pipe, copy_id) == NULL)) {
+        TracePrintf(0, "ERROR: KernelTee, invalid copy pipe %d\n", copy_id);
+        return ERROR;
+    }
+    pipe->tee_to = copy_id;
+    return 0;
+}
 
-            // update bookkeeping
-            process_to_wake->blocked_code = NOT_BLOCKED;
+/**
+ * @brief drops every splice and tee to or from a pipe that's going away
+ * 
+ * @param pipe_id 
+ */
+static void SpliceForget(int pipe_id) {
+    for (int i = 0; i < NUM_TERMINALS; i++) {
+        if (ttySplicePipes[i] == pipe_id) ttySplicePipes[i] = NO_SPLICE;
+    }
+    for (pipe_t *pipe = head_pipe->next; pipe != NULL; pipe = pipe->next) {
+        if (pipe->splice_to == pipe_id) pipe->splice_to = NO_SPLICE;
+        if (pipe->tee_to == pipe_id) pipe->tee_to = NO_SPLICE;
+    }
+}
 
-            // remove from blocked_q
-            for (int i = 0; i < blocked_q->size; i++) {
-                // pop process off blocked queue
-                pcb_t* curr_pcb = queue_pop(blocked_q);
+/**
+ * @brief Writes the segments of iov into the pipe back to back, as one
+ * write: no other reader or writer runs in between. Unlike PipeWrite it
+ * never writes part of the data; if the pipe lacks room for all of it,
+ * nothing is written and it fails.
+ * 
+ * @param pipe_id 
+ * @param iov 
+ * @param iovcnt 
+ * @param uctxt 
+ * @return int bytes written, ERROR otherwise
+ */
+int KernelPipeWritev(int pipe_id, io_vec_t *iov, int iovcnt, UserContext *uctxt) {
+    int len = IovLength(iov, iovcnt, PROT_READ);
+    if (len == ERROR || len > PIPE_BUFFER_LEN) {
+        TracePrintf(0, "ERROR: KernelPipeWritev, invalid segments\n");
+        return ERROR;
+    }
+    return PipeWriteIov(pipe_id, iov, len, 1, uctxt);
+}
 
-                // if it's our desired process, we're good, otherwise add it back to queue
-                if (curr_pcb->pid = process_to_wake->pid) {
-                    queue_add(ready_q,curr_pcb,curr_pcb->pid);
-                }
-                else {
-                    queue_add(blocked_q,curr_pcb,curr_pcb->pid);
-                }
-            }
-        }
+/**
+ * @brief writes len bytes gathered from iov into the pipe, or as many as fit
+ * 
+ * @param pipe_id 
+ * @param iov 
+ * @param len 
+ * @param whole if set, write all len bytes or nothing
+ * @param uctxt 
+ * @return int bytes written, ERROR otherwise
+ */
+static int PipeWriteIov(int pipe_id, io_vec_t *iov, int len, int whole, UserContext *uctxt) {
+
+    // check ids of pipes
+    // if id matches
+    pipe_t* curr_pipe = get_pipe(head_pipe,pipe_id);
+
+    if (curr_pipe == NULL || pipe_id == PIPE_ID_BASE) {
+        TracePrintf(0,"ERROR: KernelPipeWrite, get_pipe failed\n");
+        return ERROR;
+    }
+
+    // mark pipe is being used
+    curr_pipe->being_used = PIPE_NOT_FREE;
+    TracePrintf(0,"KernelPipeWrite: marking pipe as taken...\n");
+
+
+    // int available space = max pipe length - plen
+    int available_space = PIPE_BUFFER_LEN - curr_pipe->plen;
+    int amount_written;
+
+    // a teed pipe only takes what its copy can take too, so both see the same stream
+    pipe_t *tee_pipe = curr_pipe->tee_to == NO_SPLICE ? NULL : get_pipe(head_pipe, curr_pipe->tee_to);
+    if (tee_pipe != NULL && PIPE_BUFFER_LEN - tee_pipe->plen < available_space) {
+        available_space = PIPE_BUFFER_LEN - tee_pipe->plen;
+    }
+
+    // an all or nothing write that doesn't fit leaves the pipe untouched
+    if (whole && available_space < len) {
+        TracePrintf(0,"ERROR: KernelPipeWritev, %d bytes don't fit in %d\n", len, available_space);
+        curr_pipe->being_used = PIPE_FREE;
+        return ERROR;
+    }
+
+    // if available space >= len, so if there's enough space to put all the stuff in
+    if (available_space >= len) {
+        // put len data from buf into pipe
+        IovGather(curr_pipe->buf + curr_pipe->plen, iov, 0, len);
+        TracePrintf(0,"Wrote %d many bytes\n",len);
+        // update length of pipe
+        curr_pipe->plen = curr_pipe->plen + len;
+
+        amount_written = len;
+    }
+
+
+    // else if available space < len
+    else {
+        // put available space amount of data from buf into pipe
+        IovGather(curr_pipe->buf + curr_pipe->plen, iov, 0, available_space);
+        
+        // update length of pipe
+        curr_pipe->plen = curr_pipe->plen + available_space;
+
+        amount_written = available_space;
+    }
+    
+    if (tee_pipe != NULL && amount_written > 0) {
+        memcpy(tee_pipe->buf + tee_pipe->plen, curr_pipe->buf + curr_pipe->plen - amount_written, amount_written);
+        tee_pipe->plen += amount_written;
+        SplicePump(tee_pipe);
+        PipeWakeReader(tee_pipe);
     }
 
+    // spliced bytes move on before any reader sees them
+    SplicePump(curr_pipe);
+
+    // wake a reader if there's now enough for it
+    PipeWakeReader(curr_pipe);
+
     // mark pipe as free
     TracePrintf(0,"KernelPipeWrite done, marking pipe as free...\n");
     curr_pipe->being_used = PIPE_FREE;
+    if (amount_written > 0) PollWake(POLL_PIPE_READ);
 
     // return number of bytes written
     return amount_written;
@@ -956,27 +1749,45 @@ int KernelLockInit(int *lock_idp) {
 }
 
 /**
- * @brief 
+ * @brief takes the lock, waiting up to timeout ticks for it. A waiter never
+ * races for the lock: Release makes it the owner before it runs again.
  * 
  * @param lock_id 
+ * @param timeout ticks, 0 to not wait, -1 to wait forever
  * @param uctxt 
- * @return int 
+ * @return int SUCCESS, WOULD_BLOCK, TIMED_OUT or ERROR
  */
-int KernelAcquire(int lock_id, UserContext *uctxt) {
-    if (lock_id < 0 || lock_id > MAX_LOCKS || uctxt == NULL) {
+static int LockAcquire(int lock_id, int timeout, UserContext *uctxt) {
+    if (lock_id < 0 || lock_id >= MAX_LOCKS || uctxt == NULL) {
         return ERROR;
     }
-    if (lock_status[lock_id] == UNUSED_LOCK) {
+    if (lock_status[lock_id] == UNUSED_LOCK || lock_type[lock_id] != MUTEX_LOCK) {
         return ERROR;
     }
     if (lock_status[lock_id] == activePCB->pid) {
         return ERROR;
-    } else if (lock_status[lock_id] != FREE_LOCK) {
-        activePCB->blocked_code = BLOCKED_LOCK_ACQUIRE;
-        SwapProcess(lockAquireQueues[lock_id], uctxt);
-        activePCB->blocked_code = NOT_BLOCKED;
     }
-    lock_status[lock_id] = activePCB->pid;
+    if (lock_status[lock_id] == FREE_LOCK) {
+        lock_status[lock_id] = activePCB->pid;
+        lock_stats[lock_id].acquires++;
+        return SUCCESS;
+    }
+    if (timeout == 0) return WOULD_BLOCK;
+
+    lock_stats[lock_id].contended++;
+    activePCB->blocked_code = BLOCKED_LOCK_ACQUIRE;
+    if (timeout > 0) timer_arm(activePCB, lockAquireQueues[lock_id], global_clock_ticks + timeout);
+    SwapProcess(lockAquireQueues[lock_id], uctxt);
+    activePCB->blocked_code = NOT_BLOCKED;
+    if (timeout > 0) {
+        timer_cancel(activePCB);
+        if (activePCB->timed_out) {
+            lock_stats[lock_id].timeouts++;
+            return TIMED_OUT;
+        }
+    }
+
+    // KernelRelease already made us the owner
     return SUCCESS;
 }
 
@@ -984,21 +1795,258 @@ int KernelAcquire(int lock_id, UserContext *uctxt) {
  * @brief 
  * 
  * @param lock_id 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelAcquire(int lock_id, UserContext *uctxt) {
+    return LockAcquire(lock_id, -1, uctxt);
+}
+
+/**
+ * @brief Takes the lock only if it's free
+ * 
+ * @param lock_id 
+ * @param uctxt 
+ * @return int SUCCESS, WOULD_BLOCK if it's held, ERROR otherwise
+ */
+int KernelTryAcquire(int lock_id, UserContext *uctxt) {
+    return LockAcquire(lock_id, 0, uctxt);
+}
+
+/**
+ * @brief Takes the lock, giving up after ticks clock ticks
+ * 
+ * @param lock_id 
+ * @param ticks 
+ * @param uctxt 
+ * @return int SUCCESS, TIMED_OUT, or ERROR
+ */
+int KernelAcquireTimeout(int lock_id, int ticks, UserContext *uctxt) {
+    if (ticks < 0) return ERROR;
+    int rc = LockAcquire(lock_id, ticks, uctxt);
+    return rc == WOULD_BLOCK ? TIMED_OUT : rc;
+}
+
+/**
+ * @brief Releases the lock. If anyone is waiting, the oldest waiter becomes
+ * the owner right here, before it's scheduled, so nobody can take the lock
+ * in between and waiters get it in the order they asked.
+ * 
+ * @param lock_id 
  * @return int 
  */
 int KernelRelease(int lock_id) {
-    if (lock_id < 0 || lock_id > MAX_LOCKS) return ERROR;
+    if (lock_id < 0 || lock_id >= MAX_LOCKS || lock_type[lock_id] != MUTEX_LOCK) return ERROR;
     if (lock_status[lock_id] != activePCB->pid || lock_status[lock_id] == UNUSED_LOCK) {
         return ERROR;
     }
-    lock_status[lock_id] = FREE_LOCK;
     if (lockAquireQueues[lock_id]->size > 0) {
         pcb_t *next = queue_pop(lockAquireQueues[lock_id]);
+        lock_status[lock_id] = next->pid;
+        lock_stats[lock_id].acquires++;
+        lock_stats[lock_id].handoffs++;
+        next->blocked_code = NOT_BLOCKED;
         queue_add(ready_q, next, next->pid);
+    } else {
+        lock_status[lock_id] = FREE_LOCK;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Copies the lock's counters out
+ * 
+ * @param lock_id 
+ * @param statsp 
+ * @return int 
+ */
+int KernelLockStats(int lock_id, lock_stats_t *statsp) {
+    if (lock_id < 0 || lock_id >= MAX_LOCKS || lock_status[lock_id] == UNUSED_LOCK ||
+        ValidUserRange(activePCB->user_page_table, statsp, sizeof(lock_stats_t), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+    *statsp = lock_stats[lock_id];
+    return SUCCESS;
+}
+
+/**
+ * @brief checks that lock_id names a reader-writer lock in use
+ * 
+ * @param lock_id 
+ * @return int 
+ */
+static int RWLockValid(int lock_id) {
+    if (lock_id < 0 || lock_id >= MAX_LOCKS) return 0;
+    return lock_status[lock_id] != UNUSED_LOCK && lock_type[lock_id] == RW_LOCK;
+}
+
+/**
+ * @brief passes a reader-writer lock nobody holds any more on to its
+ * waiters: the oldest writer if there is one, otherwise every waiting
+ * reader at once. Like Release, the waiters own the lock before they run.
+ * 
+ * @param lock_id 
+ */
+static void RWLockGrant(int lock_id) {
+    if (lockAquireQueues[lock_id]->size > 0) {
+        pcb_t *writer = queue_pop(lockAquireQueues[lock_id]);
+        lock_status[lock_id] = writer->pid;
+        lock_stats[lock_id].acquires++;
+        lock_stats[lock_id].handoffs++;
+        writer->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, writer, writer->pid);
+        return;
+    }
+    lock_status[lock_id] = rwReadQueues[lock_id]->size > 0 ? RW_READ_HELD : FREE_LOCK;
+    while (rwReadQueues[lock_id]->size > 0) {
+        pcb_t *reader = queue_pop(rwReadQueues[lock_id]);
+        lock_readers[lock_id]++;
+        queue_add(rwReadHolders[lock_id], reader, reader->pid);
+        lock_stats[lock_id].acquires++;
+        lock_stats[lock_id].read_acquires++;
+        lock_stats[lock_id].handoffs++;
+        reader->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, reader, reader->pid);
+    }
+}
+
+/**
+ * @brief Creates a reader-writer lock, taking its id from the lock ids
+ * 
+ * @param lock_idp 
+ * @return int 
+ */
+int KernelRWLockInit(int *lock_idp) {
+    if (ValidUserRange(activePCB->user_page_table, lock_idp, sizeof(int), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+    if (KernelLockInit(lock_idp) == ERROR) return ERROR;
+    lock_type[*lock_idp] = RW_LOCK;
+    lock_readers[*lock_idp] = 0;
+    return SUCCESS;
+}
+
+/**
+ * @brief Takes a read hold. Readers share the lock, but a new reader waits
+ * if a writer holds it or is waiting for it, so a stream of readers can't
+ * starve writers out.
+ * 
+ * @param lock_id 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelRWLockRead(int lock_id, UserContext *uctxt) {
+    if (!RWLockValid(lock_id) || lock_status[lock_id] == activePCB->pid || uctxt == NULL) {
+        return ERROR;
+    }
+    if ((lock_status[lock_id] == FREE_LOCK || lock_status[lock_id] == RW_READ_HELD) &&
+        lockAquireQueues[lock_id]->size == 0) {
+        lock_status[lock_id] = RW_READ_HELD;
+        lock_readers[lock_id]++;
+        queue_add(rwReadHolders[lock_id], activePCB, activePCB->pid);
+        lock_stats[lock_id].acquires++;
+        lock_stats[lock_id].read_acquires++;
+        return SUCCESS;
     }
+
+    int start = global_clock_ticks;
+    lock_stats[lock_id].contended++;
+    lock_stats[lock_id].read_waits++;
+    activePCB->blocked_code = BLOCKED_RW_READ;
+    SwapProcess(rwReadQueues[lock_id], uctxt);
+    activePCB->blocked_code = NOT_BLOCKED;
+    lock_stats[lock_id].read_wait_ticks += global_clock_ticks - start;
+
+    // RWLockGrant already counted us as a reader
+    return SUCCESS;
+}
+
+/**
+ * @brief Takes the lock for writing, waiting until nobody holds it
+ * 
+ * @param lock_id 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelRWLockWrite(int lock_id, UserContext *uctxt) {
+    if (!RWLockValid(lock_id) || lock_status[lock_id] == activePCB->pid || uctxt == NULL) {
+        return ERROR;
+    }
+    if (lock_status[lock_id] == FREE_LOCK) {
+        lock_status[lock_id] = activePCB->pid;
+        lock_stats[lock_id].acquires++;
+        return SUCCESS;
+    }
+
+    int start = global_clock_ticks;
+    lock_stats[lock_id].contended++;
+    lock_stats[lock_id].write_waits++;
+    activePCB->blocked_code = BLOCKED_RW_WRITE;
+    SwapProcess(lockAquireQueues[lock_id], uctxt);
+    activePCB->blocked_code = NOT_BLOCKED;
+    lock_stats[lock_id].write_wait_ticks += global_clock_ticks - start;
+
+    // RWLockGrant already made us the owner
     return SUCCESS;
 }
 
+/**
+ * @brief Drops the caller's write hold or one of its read holds on this
+ * lock. A process holding no read hold on lock_id can't drop one here.
+ * 
+ * @param lock_id 
+ * @return int 
+ */
+int KernelRWLockRelease(int lock_id) {
+    if (!RWLockValid(lock_id)) return ERROR;
+    if (lock_status[lock_id] == activePCB->pid) {
+        RWLockGrant(lock_id);
+        return SUCCESS;
+    }
+    if (lock_status[lock_id] != RW_READ_HELD ||
+        queue_remove(rwReadHolders[lock_id], activePCB->pid) == NULL) {
+        return ERROR;
+    }
+    if (--lock_readers[lock_id] == 0) RWLockGrant(lock_id);
+    return SUCCESS;
+}
+
+/**
+ * @brief maps a cvar id to its slot in the cvar arrays
+ * 
+ * @param cvar_id 
+ * @return int index, ERROR if the id isn't a cvar in use
+ */
+static int CvarIndex(int cvar_id) {
+    int index = cvar_id - MAX_LOCKS - 1;
+    if (index < 0 || index >= MAX_CVARS || cvar_status[index] == UNUSED_CVAR) return ERROR;
+    return index;
+}
+
+/**
+ * @brief moves a signalled waiter on to the lock it gave up in CvarWait:
+ * it becomes the owner right away if the lock is free, otherwise it waits
+ * in the lock's queue and Release hands it the lock. Either way it only
+ * runs once, already holding the lock.
+ * 
+ * @param waiter 
+ */
+static void CvarMorph(pcb_t *waiter) {
+    int lock_id = waiter->cvar_lock;
+    // signalled in time, from here on it waits for the lock like anyone else
+    timer_cancel(waiter);
+    if (lock_status[lock_id] == FREE_LOCK) {
+        lock_status[lock_id] = waiter->pid;
+        lock_stats[lock_id].acquires++;
+        waiter->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, waiter, waiter->pid);
+    } else {
+        lock_stats[lock_id].contended++;
+        waiter->blocked_code = BLOCKED_LOCK_ACQUIRE;
+        queue_add(lockAquireQueues[lock_id], waiter, waiter->pid);
+    }
+}
+
 /**
  * @brief 
  * 
@@ -1012,94 +2060,1291 @@ int KernelCvarInit(int *cvar_idp) {
         return ERROR;
     }
     *cvar_idp = (int) list_pop(cvar_list);
-    cvar_status[(*cvar_idp) - MAX_LOCKS] = USED_CVAR;
+    cvar_status[(*cvar_idp) - MAX_LOCKS - 1] = USED_CVAR;
     return SUCCESS;
 }
 
 /**
- * @brief 
+ * @brief Moves the oldest waiter over to its lock
  * 
  * @param cvar_idp 
  * @param uctxt 
  * @return int 
  */
 int KernelCvarSignal(int cvar_idp, UserContext *uctxt) {
-    if (cvar_idp < 0 || uctxt == NULL || cvar_status[cvar_idp - MAX_LOCKS] == UNUSED_CVAR) return ERROR;
-    if (cvarWaitQueues[cvar_idp - MAX_LOCKS]->size > 0) {
-        pcb_t *receiver = queue_pop(cvarWaitQueues[cvar_idp - MAX_LOCKS]);
-        queue_add(ready_q, receiver, receiver->pid);
+    int index = CvarIndex(cvar_idp);
+    if (index == ERROR || uctxt == NULL) return ERROR;
+    if (cvarWaitQueues[index]->size > 0) {
+        CvarMorph(queue_pop(cvarWaitQueues[index]));
     }
     return SUCCESS;
 }
 
 /**
- * @brief 
+ * @brief Moves every waiter over to its lock, in the order they waited
  * 
  * @param cvar_idp 
  * @param uctxt 
  * @return int 
  */
 int KernelCvarBroadcast(int cvar_idp, UserContext *uctxt) {
-    if (cvar_idp < 0 || uctxt == NULL || cvar_status[cvar_idp - MAX_LOCKS] == UNUSED_CVAR) return ERROR;
+    int index = CvarIndex(cvar_idp);
+    if (index == ERROR || uctxt == NULL) return ERROR;
     pcb_t *receiver;
-    while ( (receiver = queue_pop(cvarWaitQueues[cvar_idp - MAX_LOCKS])) != NULL ) {
-        queue_add(ready_q, receiver, receiver->pid);
+    while ( (receiver = queue_pop(cvarWaitQueues[index])) != NULL ) {
+        CvarMorph(receiver);
     }
     return SUCCESS;
 }
 
 /**
- * @brief 
+ * @brief Releases the lock and waits on the cvar. Signal or Broadcast
+ * moves the waiter straight to the lock, so it returns holding it. A
+ * waiter whose timeout runs out first takes the lock back itself.
  * 
  * @param cvar_idp 
  * @param lock_id 
+ * @param timeout ticks, -1 to wait forever
  * @param uctxt 
- * @return int 
+ * @return int SUCCESS, TIMED_OUT or ERROR
  */
-int KernelCvarWait(int cvar_idp, int lock_id, UserContext *uctxt) {
-    if (cvar_idp < 0 || 
-        cvar_status[cvar_idp - MAX_LOCKS] == UNUSED_CVAR ||
-        lock_id < 0 ||
+static int CvarWaitFor(int cvar_idp, int lock_id, int timeout, UserContext *uctxt) {
+    int index = CvarIndex(cvar_idp);
+    if (index == ERROR ||
+        lock_id < 0 || lock_id >= MAX_LOCKS ||
         lock_status[lock_id] == UNUSED_LOCK ||
         uctxt == NULL
    ) {
        return ERROR;
    }
    if (KernelRelease(lock_id) == ERROR) return ERROR;
-   SwapProcess(cvarWaitQueues[cvar_idp - MAX_LOCKS], uctxt);
-   return KernelAcquire(lock_id, uctxt);
+   activePCB->cvar_lock = lock_id;
+   activePCB->blocked_code = BLOCKED_CVAR_WAIT;
+   if (timeout >= 0) timer_arm(activePCB, cvarWaitQueues[index], global_clock_ticks + timeout);
+   SwapProcess(cvarWaitQueues[index], uctxt);
+   activePCB->blocked_code = NOT_BLOCKED;
+   if (timeout >= 0) {
+       timer_cancel(activePCB);
+       // nobody signalled us, so nobody moved us to the lock either
+       if (activePCB->timed_out) {
+           LockAcquire(lock_id, -1, uctxt);
+           return TIMED_OUT;
+       }
+   }
+   return SUCCESS;
 }
 
 /**
- * @brief Reclaims an id by destroying a lock, condition variable, or pipe. Releases any associate resources. 
+ * @brief 
  * 
- * @param id 
+ * @param cvar_idp 
+ * @param lock_id 
+ * @param uctxt 
  * @return int 
  */
-int KernelReclaim(int id) { // Order of ID's should be as follows lock, condition variable, then pipe...
-    if (id < 0) {
-        TracePrintf(0, "ERROR: KernelReclaim, id < 0\n");
-    }
+int KernelCvarWait(int cvar_idp, int lock_id, UserContext *uctxt) {
+    return CvarWaitFor(cvar_idp, lock_id, -1, uctxt);
+}
 
-    if (id <= MAX_LOCKS) {
-        // Add the lock id back to the list of free lock ids.
-        if (list_add(lock_list, (void *) id) == ERROR) {
-            TracePrintf(0, "ERROR: KernelReclaim, adding to lock list failed");
-            return ERROR;
-        }
-    } else if (id <= MAX_CVARS + MAX_LOCKS) {
-        // Add the cvar id back to the list of free cvar ids.
-        if (list_add(cvar_list, (void *) id) == ERROR) {
-            TracePrintf(0, "ERROR: KernelReclaim, adding to cvar list failed");
-            return ERROR;
-        }
-    } else {
-        // Remove the pipe by id using the remove pipe function.
-        if (remove_pipe(head_pipe, id) == ERROR) {
-            TracePrintf(0, "ERROR: KernelReclaim, Failed to remove pipe.\n");
-            return ERROR;
-        }        
+/**
+ * @brief Waits on the cvar for at most ticks clock ticks
+ * 
+ * @param cvar_idp 
+ * @param lock_id 
+ * @param ticks 
+ * @param uctxt 
+ * @return int SUCCESS, TIMED_OUT or ERROR; the lock is held again either way
+ */
+int KernelCvarWaitTimeout(int cvar_idp, int lock_id, int ticks, UserContext *uctxt) {
+    if (ticks < 0) return ERROR;
+    return CvarWaitFor(cvar_idp, lock_id, ticks, uctxt);
+}
+
+/**
+ * @brief Creates a counting semaphore with the given initial value
+ * 
+ * @param sem_idp where the id of the semaphore is saved
+ * @param value 
+ * @return int 
+ */
+int KernelSemInit(int *sem_idp, int value) {
+    if (ValidUserRange(activePCB->user_page_table, sem_idp, sizeof(int), PROT_WRITE) == ERROR ||
+        value < 0) {
+        return ERROR;
+    }
+    if (sem_list->size == 0) {
+        *sem_idp = ERROR;
+        return ERROR;
     }
+    *sem_idp = (int) list_pop(sem_list);
+    sem_status[*sem_idp - SEM_ID_BASE] = USED_SEM;
+    sem_value[*sem_idp - SEM_ID_BASE] = value;
+    return SUCCESS;
+}
 
-    return 0;
+/**
+ * @brief Adds n to the semaphore, then hands units to waiters in FIFO order
+ * for as long as the one at the head can be satisfied. Woken waiters already
+ * own their units, so they never re-check or block again.
+ * 
+ * @param sem_id 
+ * @param n 
+ * @return int 
+ */
+int KernelSemUp(int sem_id, int n) {
+    int index = sem_id - SEM_ID_BASE;
+    if (index < 0 || index >= MAX_SEMS || sem_status[index] == UNUSED_SEM || n <= 0) {
+        return ERROR;
+    }
+    sem_value[index] += n;
+
+    pcb_t *waiter;
+    while ((waiter = queue_peek(semWaitQueues[index])) != NULL && waiter->sem_count <= sem_value[index]) {
+        queue_pop(semWaitQueues[index]);
+        sem_value[index] -= waiter->sem_count;
+        waiter->sem_count = 0;
+        waiter->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, waiter, waiter->pid);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Takes n from the semaphore, blocking until n are available.
+ * Waiters are served in arrival order, so a large request isn't starved
+ * by a stream of small ones.
+ * 
+ * @param sem_id 
+ * @param n 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelSemDown(int sem_id, int n, UserContext *uctxt) {
+    int index = sem_id - SEM_ID_BASE;
+    if (index < 0 || index >= MAX_SEMS || sem_status[index] == UNUSED_SEM || n <= 0 || uctxt == NULL) {
+        return ERROR;
+    }
+    if (semWaitQueues[index]->size == 0 && sem_value[index] >= n) {
+        sem_value[index] -= n;
+        return SUCCESS;
+    }
+
+    // KernelSemUp takes our units for us before waking us
+    activePCB->sem_count = n;
+    activePCB->blocked_code = BLOCKED_SEM_DOWN;
+    SwapProcess(semWaitQueues[index], uctxt);
+    return SUCCESS;
+}
+
+/**
+ * @brief Takes 1 from the semaphore if that can be done without blocking
+ * 
+ * @param sem_id 
+ * @return int 0 if taken, WOULD_BLOCK if not, ERROR otherwise
+ */
+int KernelSemTryDown(int sem_id) {
+    int index = sem_id - SEM_ID_BASE;
+    if (index < 0 || index >= MAX_SEMS || sem_status[index] == UNUSED_SEM) {
+        return ERROR;
+    }
+    if (semWaitQueues[index]->size > 0 || sem_value[index] < 1) {
+        return WOULD_BLOCK;
+    }
+    sem_value[index]--;
+    return SUCCESS;
+}
+
+/**
+ * @brief Creates a barrier for the given number of processes
+ * 
+ * @param barrier_idp where the id of the barrier is saved
+ * @param parties 
+ * @return int 
+ */
+int KernelBarrierInit(int *barrier_idp, int parties) {
+    if (parties < 1 ||
+        ValidUserRange(activePCB->user_page_table, barrier_idp, sizeof(int), PROT_WRITE) == ERROR) {
+        return ERROR;
+    }
+    if (barrier_list->size == 0) {
+        *barrier_idp = ERROR;
+        return ERROR;
+    }
+    *barrier_idp = (int) list_pop(barrier_list);
+    barrier_parties[*barrier_idp - BARRIER_ID_BASE] = parties;
+    barrier_arrived[*barrier_idp - BARRIER_ID_BASE] = 0;
+    return SUCCESS;
+}
+
+/**
+ * @brief Blocks until every party has reached the barrier. The last to
+ * arrive readies everyone waiting in one pass and resets the count, so the
+ * barrier is ready for the next round before any of them runs again.
+ * 
+ * @param barrier_id 
+ * @param uctxt 
+ * @return int BARRIER_SERIAL for the last to arrive, 0 for the rest, ERROR otherwise
+ */
+int KernelBarrierWait(int barrier_id, UserContext *uctxt) {
+    int index = barrier_id - BARRIER_ID_BASE;
+    if (index < 0 || index >= MAX_BARRIERS || barrier_parties[index] == 0 || uctxt == NULL) {
+        return ERROR;
+    }
+    if (++barrier_arrived[index] < barrier_parties[index]) {
+        activePCB->blocked_code = BLOCKED_BARRIER;
+        SwapProcess(barrierWaitQueues[index], uctxt);
+        return 0;
+    }
+
+    barrier_arrived[index] = 0;
+    pcb_t *waiter;
+    while ((waiter = queue_pop(barrierWaitQueues[index])) != NULL) {
+        waiter->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, waiter, waiter->pid);
+    }
+    return BARRIER_SERIAL;
+}
+
+/**
+ * @brief Reclaims an id by destroying a lock, condition variable, or pipe. Releases any associate resources. 
+ * 
+ * @param id 
+ * @return int 
+ */
+int KernelReclaim(int id) { // Order of ID's should be as follows lock, condition variable, shared memory, semaphore, broadcast channel, message queue, barrier, then pipe...
+    if (id < 0) {
+        TracePrintf(0, "ERROR: KernelReclaim, id < 0\n");
+        return ERROR;
+    }
+
+    if (id <= MAX_LOCKS) {
+        // Locks that are held or waited on can't be reclaimed
+        if (id == MAX_LOCKS || lock_status[id] != FREE_LOCK ||
+            lockAquireQueues[id]->size > 0 || rwReadQueues[id]->size > 0) {
+            TracePrintf(0, "ERROR: KernelReclaim, lock %d unused, held or waited on\n", id);
+            return ERROR;
+        }
+        lock_status[id] = UNUSED_LOCK;
+        lock_type[id] = MUTEX_LOCK;
+        memset(&lock_stats[id], 0, sizeof(lock_stats_t));
+        // Add the lock id back to the list of free lock ids.
+        if (list_add(lock_list, (void *) id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, adding to lock list failed");
+            return ERROR;
+        }
+    } else if (id <= MAX_CVARS + MAX_LOCKS) {
+        // Cvars with waiters can't be reclaimed
+        int index = CvarIndex(id);
+        if (index == ERROR || cvarWaitQueues[index]->size > 0) {
+            TracePrintf(0, "ERROR: KernelReclaim, cvar %d unused or has waiters\n", id);
+            return ERROR;
+        }
+        cvar_status[index] = UNUSED_CVAR;
+        // Add the cvar id back to the list of free cvar ids.
+        if (list_add(cvar_list, (void *) id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, adding to cvar list failed");
+            return ERROR;
+        }
+    } else if (id < SEM_ID_BASE) {
+        // Drop the segment, its frames stay until every process detaches
+        if (shm_reclaim(id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, Failed to reclaim shared memory.\n");
+            return ERROR;
+        }
+    } else if (id < BCAST_ID_BASE) {
+        // Semaphores can't be reclaimed out from under their waiters
+        int index = id - SEM_ID_BASE;
+        if (sem_status[index] == UNUSED_SEM || semWaitQueues[index]->size > 0) {
+            TracePrintf(0, "ERROR: KernelReclaim, semaphore %d unused or has waiters\n", id);
+            return ERROR;
+        }
+        sem_status[index] = UNUSED_SEM;
+        sem_value[index] = 0;
+        if (list_add(sem_list, (void *) id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, adding to sem list failed");
+            return ERROR;
+        }
+    } else if (id < MSGQ_ID_BASE) {
+        // Channels with blocked readers or writers can't be reclaimed
+        if (bcast_reclaim(id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, Failed to reclaim channel %d.\n", id);
+            return ERROR;
+        }
+    } else if (id < BARRIER_ID_BASE) {
+        // Queued messages go with the queue, blocked processes keep it alive
+        if (msgq_reclaim(id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, Failed to reclaim message queue %d.\n", id);
+            return ERROR;
+        }
+    } else if (id < PIPE_ID_BASE) {
+        // Barriers with parties waiting at them can't be reclaimed
+        int index = id - BARRIER_ID_BASE;
+        if (barrier_parties[index] == 0 || barrierWaitQueues[index]->size > 0) {
+            TracePrintf(0, "ERROR: KernelReclaim, barrier %d unused or has waiters\n", id);
+            return ERROR;
+        }
+        barrier_parties[index] = 0;
+        barrier_arrived[index] = 0;
+        if (list_add(barrier_list, (void *) id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, adding to barrier list failed");
+            return ERROR;
+        }
+    } else {
+        // readers blocked on the pipe would be left waiting on freed memory
+        pipe_t *pipe = get_pipe(head_pipe, id);
+        if (pipe != NULL && pipe->queue->size > 0) {
+            TracePrintf(0, "ERROR: KernelReclaim, pipe %d still has readers\n", id);
+            return ERROR;
+        }
+        SpliceForget(id);
+        // Remove the pipe by id using the remove pipe function.
+        if (remove_pipe(head_pipe, id) == ERROR) {
+            TracePrintf(0, "ERROR: KernelReclaim, Failed to remove pipe.\n");
+            return ERROR;
+        }        
+        PollWake(POLL_PIPE_READ | POLL_PIPE_WRITE);
+    }
+
+    return 0;
+}
+
+
+// ==========================================
+// =         Shared Memory Syscalls         =
+// ==========================================
+
+/**
+ * @brief Creates a shared memory segment of npages pages
+ * 
+ * @param shm_idp where the id of the segment is saved
+ * @param npages 
+ * @return int 
+ */
+int KernelShmInit(int *shm_idp, int npages) {
+    if (ValidUserRange(activePCB->user_page_table, shm_idp, sizeof(int), PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelShmInit, invalid id pointer %p\n", shm_idp);
+        return ERROR;
+    }
+    int id = shm_create(npages);
+    if (id == ERROR) {
+        TracePrintf(0, "ERROR: KernelShmInit, failed to create %d page segment\n", npages);
+        return ERROR;
+    }
+    *shm_idp = id;
+    return 0;
+}
+
+/**
+ * @brief Maps a shared memory segment into the caller's region 1, between
+ * the heap and the stack
+ * 
+ * @param shm_id 
+ * @param addrp where the address of the mapping is saved
+ * @return int 
+ */
+int KernelShmAttach(int shm_id, void **addrp) {
+    if (ValidUserRange(activePCB->user_page_table, addrp, sizeof(void *), PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelShmAttach, invalid address pointer %p\n", addrp);
+        return ERROR;
+    }
+    shm_segment_t *seg = get_shm(shm_id);
+    if (seg == NULL) {
+        TracePrintf(0, "ERROR: KernelShmAttach, no segment %d\n", shm_id);
+        return ERROR;
+    }
+    int page = shm_attach(seg, activePCB);
+    if (page == ERROR) return ERROR;
+
+    *addrp = (void *) (VMEM_1_BASE + (page << PAGESHIFT));
+    return 0;
+}
+
+/**
+ * @brief Unmaps the shared memory segment mapped at addr
+ * 
+ * @param addr 
+ * @return int 
+ */
+int KernelShmDetach(void *addr) {
+    if ((unsigned int) addr < VMEM_1_BASE || (unsigned int) addr >= VMEM_1_LIMIT || ((unsigned int) addr & PAGEOFFSET) != 0) {
+        TracePrintf(0, "ERROR: KernelShmDetach, invalid address %p\n", addr);
+        return ERROR;
+    }
+    int page = ((unsigned int) addr - VMEM_1_BASE) >> PAGESHIFT;
+    return shm_detach(activePCB, page);
+}
+
+
+// ==========================================
+// =             Futex Syscalls             =
+// ==========================================
+
+/**
+ * @brief turns a user address into the physical address used as a futex key,
+ * so processes mapping the same shared frame agree on it
+ * 
+ * @param addr 
+ * @param keyp where the key is saved
+ * @return int 0 if success, ERROR if addr isn't a readable, aligned word
+ */
+static int FutexKey(int *addr, unsigned int *keyp) {
+    if (((unsigned int) addr & (sizeof(int) - 1)) != 0 ||
+        ValidUserRange(activePCB->user_page_table, addr, sizeof(int), PROT_READ) == ERROR) {
+        return ERROR;
+    }
+    int page = ((unsigned int) addr - VMEM_1_BASE) >> PAGESHIFT;
+    *keyp = (activePCB->user_page_table[page].pfn << PAGESHIFT) | ((unsigned int) addr & PAGEOFFSET);
+    return 0;
+}
+
+/**
+ * @brief Blocks the caller on addr if *addr still equals val. The check and
+ * the block happen without any other process running in between, so a
+ * FutexWake issued after the value changes can't be missed.
+ * 
+ * @param addr 
+ * @param val 
+ * @param uctxt 
+ * @return int 0 once woken, WOULD_BLOCK if *addr != val, ERROR otherwise
+ */
+int KernelFutexWait(int *addr, int val, UserContext *uctxt) {
+    unsigned int key;
+    if (uctxt == NULL || FutexKey(addr, &key) == ERROR) {
+        TracePrintf(0, "ERROR: KernelFutexWait, invalid address %p\n", addr);
+        return ERROR;
+    }
+    if (*addr != val) return WOULD_BLOCK;
+
+    activePCB->futex_key = key;
+    activePCB->blocked_code = BLOCKED_FUTEX;
+    SwapProcess(futexQueues[(key >> 2) % FUTEX_BUCKETS], uctxt);
+    return 0;
+}
+
+/**
+ * @brief Wakes up to n processes blocked in FutexWait on addr, oldest first
+ * 
+ * @param addr 
+ * @param n 
+ * @return int number of processes woken, ERROR otherwise
+ */
+int KernelFutexWake(int *addr, int n) {
+    unsigned int key;
+    if (n < 0 || FutexKey(addr, &key) == ERROR) {
+        TracePrintf(0, "ERROR: KernelFutexWake, invalid address %p\n", addr);
+        return ERROR;
+    }
+
+    queue_t *bucket = futexQueues[(key >> 2) % FUTEX_BUCKETS];
+    int woken = 0;
+    qnode_t *node = bucket->head;
+    while (node != NULL && woken < n) {
+        pcb_t *waiter = node->data;
+        node = node->next;
+        if (waiter->futex_key == key) {
+            queue_remove(bucket, waiter->pid);
+            waiter->futex_key = 0;
+            waiter->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, waiter, waiter->pid);
+            woken++;
+        }
+    }
+    return woken;
+}
+
+
+// ==========================================
+// =              Poll Syscall              =
+// ==========================================
+
+/**
+ * @brief checks one poll entry against the current state of its object
+ * 
+ * @param entry 
+ * @return int POLL_* mask of the requested events that are ready
+ */
+static int PollCheck(poll_entry_t *entry) {
+    int ready = 0;
+    int events = entry->events;
+
+    if (events & (POLL_PIPE_READ | POLL_PIPE_WRITE)) {
+        pipe_t *pipe = get_pipe(head_pipe, entry->id);
+        if (pipe == NULL || entry->id == PIPE_ID_BASE) return POLL_INVALID;
+        if ((events & POLL_PIPE_READ) && pipe->plen > 0) ready |= POLL_PIPE_READ;
+        if ((events & POLL_PIPE_WRITE) && pipe->plen < PIPE_BUFFER_LEN) ready |= POLL_PIPE_WRITE;
+    }
+
+    if (events & (POLL_TTY_READ | POLL_TTY_WRITE)) {
+        if (entry->id < 0 || entry->id >= NUM_TERMINALS) return POLL_INVALID;
+        if ((events & POLL_TTY_READ) && tty_input_ready(entry->id) > 0) ready |= POLL_TTY_READ;
+        if ((events & POLL_TTY_WRITE) && ttyWriteQueues[entry->id]->size == 0 &&
+            tty_output_room(entry->id) > 0) {
+            ready |= POLL_TTY_WRITE;
+        }
+    }
+
+    if ((events & POLL_CHILD_EXIT) && activePCB->zombies->size > 0) {
+        ready |= POLL_CHILD_EXIT;
+    }
+    return ready;
+}
+
+/**
+ * @brief Blocks until one of the entries is ready or timeout ticks pass.
+ * Every wakeup rechecks the whole set, so a wakeup meant for another
+ * poller only costs a rescan.
+ * 
+ * @param entries 
+ * @param nentries 
+ * @param timeout ticks, 0 to only check, -1 for no timeout
+ * @param uctxt 
+ * @return int number of ready entries, 0 on timeout, ERROR otherwise
+ */
+int KernelPoll(poll_entry_t *entries, int nentries, int timeout, UserContext *uctxt) {
+    if (uctxt == NULL || nentries <= 0 || nentries > MAX_POLL_ENTRIES || timeout < -1 ||
+        ValidUserRange(activePCB->user_page_table, entries, nentries * sizeof(poll_entry_t),
+                       PROT_READ | PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelPoll, invalid arguments\n");
+        return ERROR;
+    }
+
+    int interest = 0;
+    for (int i = 0; i < nentries; i++) interest |= entries[i].events;
+
+    int deadline = global_clock_ticks + timeout;
+    while (1) {
+        int nready = 0;
+        for (int i = 0; i < nentries; i++) {
+            entries[i].revents = PollCheck(&entries[i]);
+            if (entries[i].revents != 0) nready++;
+        }
+        if (nready > 0 || timeout == 0) return nready;
+        if (timeout > 0 && global_clock_ticks >= deadline) return 0;
+
+        activePCB->poll_events = interest;
+        activePCB->blocked_code = BLOCKED_POLL;
+        if (timeout > 0) timer_arm(activePCB, poll_q, deadline);
+        SwapProcess(poll_q, uctxt);
+        timer_cancel(activePCB);
+        activePCB->poll_events = 0;
+    }
+}
+
+/**
+ * @brief Wakes every process in Poll waiting on any of the kinds in events
+ * 
+ * @param events POLL_* mask
+ */
+void PollWake(int events) {
+    qnode_t *node = poll_q->head;
+    while (node != NULL) {
+        pcb_t *poller = node->data;
+        node = node->next;
+        if (poller->poll_events & events) {
+            queue_remove(poll_q, poller->pid);
+            poller->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, poller, poller->pid);
+        }
+    }
+}
+
+
+// ==========================================
+// =       Broadcast Channel Syscalls       =
+// ==========================================
+
+/**
+ * @brief Creates a broadcast channel
+ * 
+ * @param bcast_idp where the id is saved
+ * @param policy BCAST_BLOCK or BCAST_DROP
+ * @return int 
+ */
+int KernelBcastInit(int *bcast_idp, int policy) {
+    if (ValidUserRange(activePCB->user_page_table, bcast_idp, sizeof(int), PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelBcastInit, invalid id pointer %p\n", bcast_idp);
+        return ERROR;
+    }
+    int id = bcast_create(policy);
+    if (id == ERROR) {
+        TracePrintf(0, "ERROR: KernelBcastInit, failed to create channel\n");
+        return ERROR;
+    }
+    *bcast_idp = id;
+    return 0;
+}
+
+/**
+ * @brief Subscribes the caller to the channel, from the next byte written
+ * 
+ * @param bcast_id 
+ * @return int 
+ */
+int KernelBcastSubscribe(int bcast_id) {
+    bcast_t *bc = get_bcast(bcast_id);
+    if (bc == NULL) return ERROR;
+    return bcast_subscribe(bc, activePCB->pid);
+}
+
+/**
+ * @brief Drops the caller's subscription to the channel
+ * 
+ * @param bcast_id 
+ * @return int 
+ */
+int KernelBcastUnsubscribe(int bcast_id) {
+    bcast_t *bc = get_bcast(bcast_id);
+    if (bc == NULL) return ERROR;
+    return bcast_unsubscribe(bc, activePCB->pid);
+}
+
+/**
+ * @brief Appends len bytes to the channel for every subscriber. The bytes
+ * are copied once, however many subscribers there are. A BCAST_BLOCK
+ * channel writes as much as the slowest subscriber leaves room for and
+ * waits for the rest; a BCAST_DROP channel never waits.
+ * 
+ * @param bcast_id 
+ * @param buf 
+ * @param len 
+ * @param uctxt 
+ * @return int bytes written, ERROR otherwise
+ */
+int KernelBcastWrite(int bcast_id, void *buf, int len, UserContext *uctxt) {
+    bcast_t *bc = get_bcast(bcast_id);
+    if (bc == NULL || len < 0 ||
+        ValidUserRange(activePCB->user_page_table, buf, len, PROT_READ) == ERROR) {
+        TracePrintf(0, "ERROR: KernelBcastWrite, invalid arguments\n");
+        return ERROR;
+    }
+
+    int written = 0;
+    while (written < len) {
+        int n = len - written;
+        if (bc->policy == BCAST_BLOCK) {
+            int space = bcast_space(bc);
+            if (space == 0) {
+                activePCB->blocked_code = BLOCKED_BCAST_WRITE;
+                SwapProcess(bc->writers, uctxt);
+                continue;
+            }
+            if (n > space) n = space;
+        }
+        bcast_put(bc, (char *) buf + written, n);
+        written += n;
+        bcast_wake(bc->readers);
+    }
+    return written;
+}
+
+/**
+ * @brief Reads up to len of the caller's unread bytes, blocking until there
+ * are some
+ * 
+ * @param bcast_id 
+ * @param buf 
+ * @param len 
+ * @param uctxt 
+ * @return int bytes read, ERROR otherwise
+ */
+int KernelBcastRead(int bcast_id, void *buf, int len, UserContext *uctxt) {
+    bcast_t *bc = get_bcast(bcast_id);
+    if (bc == NULL || len < 0 ||
+        ValidUserRange(activePCB->user_page_table, buf, len, PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelBcastRead, invalid arguments\n");
+        return ERROR;
+    }
+
+    bcast_sub_t *sub = bcast_get_sub(bc, activePCB->pid);
+    if (sub == NULL) {
+        TracePrintf(0, "ERROR: KernelBcastRead, process %d isn't subscribed to %d\n", activePCB->pid, bcast_id);
+        return ERROR;
+    }
+    if (len == 0) return 0;
+
+    while (bc->head == sub->pos) {
+        activePCB->blocked_code = BLOCKED_BCAST_READ;
+        SwapProcess(bc->readers, uctxt);
+        // a drop channel may have lapped us while we slept
+        sub = bcast_get_sub(bc, activePCB->pid);
+    }
+
+    int n = bcast_get(bc, sub, buf, len);
+    if (bc->policy == BCAST_BLOCK) bcast_wake(bc->writers);
+    return n;
+}
+
+/**
+ * @brief Returns and clears how many bytes the caller missed
+ * 
+ * @param bcast_id 
+ * @return int 
+ */
+int KernelBcastLost(int bcast_id) {
+    bcast_t *bc = get_bcast(bcast_id);
+    if (bc == NULL) return ERROR;
+    bcast_sub_t *sub = bcast_get_sub(bc, activePCB->pid);
+    if (sub == NULL) return ERROR;
+
+    int lost = sub->lost;
+    sub->lost = 0;
+    return lost;
+}
+
+
+// ==========================================
+// =         Message Queue Syscalls         =
+// ==========================================
+
+/**
+ * @brief Creates a message queue
+ * 
+ * @param msgq_idp where the id is saved
+ * @param max_bytes bound on queued bytes, 0 for the default
+ * @return int 
+ */
+int KernelMsgqInit(int *msgq_idp, int max_bytes) {
+    if (ValidUserRange(activePCB->user_page_table, msgq_idp, sizeof(int), PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelMsgqInit, invalid id pointer %p\n", msgq_idp);
+        return ERROR;
+    }
+    int id = msgq_create(max_bytes);
+    if (id == ERROR) {
+        TracePrintf(0, "ERROR: KernelMsgqInit, failed to create queue\n");
+        return ERROR;
+    }
+    *msgq_idp = id;
+    return 0;
+}
+
+/**
+ * @brief Queues a copy of the message and returns, waiting only while the
+ * queue is too full to take it
+ * 
+ * @param msgq_id 
+ * @param buf 
+ * @param len 
+ * @param prio higher is delivered first
+ * @param uctxt 
+ * @return int 
+ */
+int KernelMsgqSend(int msgq_id, void *buf, int len, int prio, UserContext *uctxt) {
+    msgq_t *mq = get_msgq(msgq_id);
+    if (mq == NULL || len < 0 || len > mq->max_bytes ||
+        ValidUserRange(activePCB->user_page_table, buf, len, PROT_READ) == ERROR) {
+        TracePrintf(0, "ERROR: KernelMsgqSend, invalid arguments\n");
+        return ERROR;
+    }
+
+    while (mq->bytes + len > mq->max_bytes) {
+        activePCB->blocked_code = BLOCKED_MSGQ_SEND;
+        SwapProcess(mq->senders, uctxt);
+    }
+    if (msgq_put(mq, buf, len, prio) == ERROR) {
+        TracePrintf(0, "ERROR: KernelMsgqSend, failed to queue message\n");
+        return ERROR;
+    }
+
+    // one message, one receiver
+    if (mq->receivers->size > 0) {
+        pcb_t *receiver = queue_pop(mq->receivers);
+        receiver->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, receiver, receiver->pid);
+    }
+    return 0;
+}
+
+/**
+ * @brief Takes the highest priority message, waiting if there's none
+ * 
+ * @param msgq_id 
+ * @param buf 
+ * @param len 
+ * @param priop where the message's priority is saved, may be NULL
+ * @param uctxt 
+ * @return int length of the message, ERROR otherwise
+ */
+int KernelMsgqReceive(int msgq_id, void *buf, int len, int *priop, UserContext *uctxt) {
+    msgq_t *mq = get_msgq(msgq_id);
+    if (mq == NULL || len < 0 ||
+        ValidUserRange(activePCB->user_page_table, buf, len, PROT_WRITE) == ERROR ||
+        (priop != NULL && ValidUserRange(activePCB->user_page_table, priop, sizeof(int), PROT_WRITE) == ERROR)) {
+        TracePrintf(0, "ERROR: KernelMsgqReceive, invalid arguments\n");
+        return ERROR;
+    }
+
+    while (mq->head == NULL) {
+        activePCB->blocked_code = BLOCKED_MSGQ_RECEIVE;
+        SwapProcess(mq->receivers, uctxt);
+    }
+    if (mq->head->len > len) {
+        TracePrintf(0, "ERROR: KernelMsgqReceive, %d byte message for a %d byte buffer\n", mq->head->len, len);
+        // the message stays, so pass on the wakeup its send may have spent on us
+        if (mq->receivers->size > 0) {
+            pcb_t *receiver = queue_pop(mq->receivers);
+            receiver->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, receiver, receiver->pid);
+        }
+        return ERROR;
+    }
+
+    msg_t *msg = msgq_take(mq);
+    int msg_len = msg->len;
+    memcpy(buf, msg->data, msg_len);
+    if (priop != NULL) *priop = msg->prio;
+    free(msg);
+
+    // the freed room may fit any waiting sender, let them all check
+    while (mq->senders->size > 0) {
+        pcb_t *sender = queue_pop(mq->senders);
+        sender->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, sender, sender->pid);
+    }
+    return msg_len;
+}
+
+
+// ==========================================
+// =        Submission Ring Syscalls        =
+// ==========================================
+
+/**
+ * @brief Maps a fresh submission ring page into the caller's region 1. The
+ * page is a one page shared memory segment that is reclaimed right away, so
+ * it goes away with the last process mapping it.
+ * 
+ * @param ringp where the address of the ring is saved
+ * @return int 
+ */
+int KernelRingSetup(ring_t **ringp) {
+    if (ValidUserRange(activePCB->user_page_table, ringp, sizeof(ring_t *), PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelRingSetup, invalid ring pointer %p\n", ringp);
+        return ERROR;
+    }
+    if (activePCB->ring != NULL) {
+        TracePrintf(0, "ERROR: KernelRingSetup, process %d already has a ring\n", activePCB->pid);
+        return ERROR;
+    }
+
+    int id = shm_create(1);
+    if (id == ERROR) return ERROR;
+    int page = shm_attach(get_shm(id), activePCB);
+    shm_reclaim(id);
+    if (page == ERROR) return ERROR;
+
+    ring_t *ring = (ring_t *) (VMEM_1_BASE + (page << PAGESHIFT));
+    activePCB->ring = ring;
+    *ringp = ring;
+    return 0;
+}
+
+/**
+ * @brief runs one ring operation through the same kernel call its trap
+ * would have reached
+ * 
+ * @param sqe 
+ * @param uctxt 
+ * @return int result of the operation
+ */
+static int RingExecute(ring_sqe_t *sqe, UserContext *uctxt) {
+    switch (sqe->op) {
+    case RING_OP_NOP:
+        return 0;
+    case RING_OP_TTY_WRITE:
+    case RING_OP_PIPE_READ:
+    case RING_OP_PIPE_WRITE:
+        if (sqe->len < 0 ||
+            ValidUserRange(activePCB->user_page_table, sqe->buf, sqe->len,
+                           sqe->op == RING_OP_PIPE_READ ? PROT_WRITE : PROT_READ) == ERROR) {
+            return ERROR;
+        }
+        if (sqe->op == RING_OP_TTY_WRITE) {
+            if (sqe->id < 0 || sqe->id >= NUM_TERMINALS) return ERROR;
+            return KernelTtyWrite(uctxt, sqe->id, sqe->buf, sqe->len);
+        }
+        if (get_pipe(head_pipe, sqe->id) == NULL) return ERROR;
+        if (sqe->op == RING_OP_PIPE_READ) return KernelPipeRead(sqe->id, sqe->buf, sqe->len, uctxt);
+        return KernelPipeWrite(sqe->id, sqe->buf, sqe->len, uctxt);
+    case RING_OP_ACQUIRE:
+        return KernelAcquire(sqe->id, uctxt);
+    case RING_OP_RELEASE:
+        return KernelRelease(sqe->id);
+    case RING_OP_CVAR_SIGNAL:
+        return KernelCvarSignal(sqe->id, uctxt);
+    case RING_OP_CVAR_BROADCAST:
+        return KernelCvarBroadcast(sqe->id, uctxt);
+    case RING_OP_SEM_UP:
+        return KernelSemUp(sqe->id, sqe->len);
+    case RING_OP_SEM_DOWN:
+        return KernelSemDown(sqe->id, sqe->len, uctxt);
+    default:
+        return ERROR;
+    }
+}
+
+/**
+ * @brief Runs up to n queued ring operations in submission order. Each one
+ * runs to completion (blocking the caller if it has to) before the next,
+ * and stops early if the completion queue fills up.
+ * 
+ * @param n 
+ * @param uctxt 
+ * @return int number of operations run, ERROR otherwise
+ */
+int KernelRingEnter(int n, UserContext *uctxt) {
+    ring_t *ring = activePCB->ring;
+    if (ring == NULL || n < 0 ||
+        ValidUserRange(activePCB->user_page_table, ring, sizeof(ring_t), PROT_READ | PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelRingEnter, process %d has no usable ring\n", activePCB->pid);
+        return ERROR;
+    }
+    if (ring->sq_tail - ring->sq_head > RING_ENTRIES) {
+        TracePrintf(0, "ERROR: KernelRingEnter, corrupt submission queue\n");
+        return ERROR;
+    }
+
+    int done = 0;
+    while (done < n && ring->sq_head != ring->sq_tail &&
+           ring->cq_tail - ring->cq_head < RING_ENTRIES) {
+        // copy the entry out first, the process can't change it under us
+        ring_sqe_t sqe = ring->sq[ring->sq_head % RING_ENTRIES];
+        ring->sq_head++;
+
+        int result = RingExecute(&sqe, uctxt);
+
+        ring_cqe_t *cqe = &ring->cq[ring->cq_tail % RING_ENTRIES];
+        cqe->user_data = sqe.user_data;
+        cqe->result = result;
+        ring->cq_tail++;
+        done++;
+    }
+    return done;
+}
+
+
+// ==========================================
+// =         Message Passing Syscalls       =
+// ==========================================
+
+/**
+ * @brief wakes a process blocked in the message passing syscalls
+ * 
+ * @param pcb process to wake
+ * @param result value its Send/Receive returns
+ */
+static void IpcWake(pcb_t *pcb, int result) {
+    queue_remove(blocked_q, pcb->pid);
+    pcb->ipc_result = result;
+    pcb->blocked_code = NOT_BLOCKED;
+    queue_add(ready_q, pcb, pcb->pid);
+}
+
+/**
+ * @brief resolves the destination of a Send or Forward, a pid if positive,
+ * a registered service id if negative
+ * 
+ * @param dest 
+ * @return pcb_t* NULL if nobody is there
+ */
+static pcb_t *IpcTarget(int dest) {
+    if (dest < 0) {
+        int service_id = -dest;
+        if (service_id >= MAX_SERVICES || service_registry[service_id] == NO_SERVICE) {
+            return NULL;
+        }
+        dest = service_registry[service_id];
+    }
+    return find_process(dest);
+}
+
+/**
+ * @brief hands the message of sender (already in sender->ipc_msg) to receiver.
+ * If receiver is blocked in a matching Receive the message is copied straight
+ * into its buffer, otherwise sender waits in receiver's senders queue.
+ * 
+ * @param sender process whose message is delivered, blocked or active
+ * @param receiver process the message goes to
+ * @param msg where the message can be read from in the current address space
+ * @return int 0 if delivered, 1 if queued, ERROR otherwise
+ */
+static int IpcDeliver(pcb_t *sender, pcb_t *receiver, void *msg) {
+    if (receiver->blocked_code == BLOCKED_RECEIVE &&
+        (receiver->ipc_partner == 0 || receiver->ipc_partner == sender->pid)) {
+        // rendezvous: copy directly into the receiver's buffer
+        if (CopyToProcess(receiver, receiver->ipc_msg, msg, IPC_MESSAGE_SIZE) == ERROR) {
+            IpcWake(receiver, ERROR);
+            return ERROR;
+        }
+        receiver->ipc_partner = sender->pid;
+        IpcWake(receiver, 0);
+        sender->ipc_partner = receiver->pid;
+        return 0;
+    }
+    sender->ipc_partner = receiver->pid;
+    return 1;
+}
+
+/**
+ * @brief Registers the calling process as the server for service_id
+ * 
+ * @param service_id 
+ * @return int 
+ */
+int KernelRegister(unsigned int service_id) {
+    if (service_id >= MAX_SERVICES) {
+        TracePrintf(0, "ERROR: KernelRegister, invalid service id %d\n", service_id);
+        return ERROR;
+    }
+    if (service_registry[service_id] != NO_SERVICE && find_process(service_registry[service_id]) != NULL) {
+        TracePrintf(0, "ERROR: KernelRegister, service %d already registered\n", service_id);
+        return ERROR;
+    }
+    service_registry[service_id] = activePCB->pid;
+    return 0;
+}
+
+/**
+ * @brief Sends the 32 byte message at msg to process dest (or service -dest)
+ * and blocks until it replies. The reply overwrites msg.
+ * 
+ * @param msg 
+ * @param dest 
+ * @param uctxt 
+ * @return int 0 on success, ERROR otherwise
+ */
+int KernelSend(void *msg, int dest, UserContext *uctxt) {
+    if (ValidUserRange(activePCB->user_page_table, msg, IPC_MESSAGE_SIZE, PROT_READ | PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelSend, invalid message buffer %p\n", msg);
+        return ERROR;
+    }
+    pcb_t *receiver = IpcTarget(dest);
+    if (receiver == NULL || receiver == activePCB) {
+        TracePrintf(0, "ERROR: KernelSend, no process for destination %d\n", dest);
+        return ERROR;
+    }
+
+    activePCB->ipc_msg = msg;
+    activePCB->ipc_result = 0;
+
+    int rc = IpcDeliver(activePCB, receiver, msg);
+    if (rc == ERROR) return ERROR;
+
+    if (rc == 0) {
+        // receiver has the message, wait for its reply
+        activePCB->blocked_code = BLOCKED_REPLY;
+        SwapProcess(blocked_q, uctxt);
+    } else {
+        // wait for the receiver to pick up the message
+        activePCB->blocked_code = BLOCKED_SEND;
+        SwapProcess(receiver->senders, uctxt);
+    }
+
+    return activePCB->ipc_result;
+}
+
+/**
+ * @brief Receives a message from pid (or from anyone if pid is 0) into msg,
+ * blocking until one is sent.
+ * 
+ * @param msg 
+ * @param pid 
+ * @param uctxt 
+ * @return int pid of the sender, ERROR otherwise
+ */
+int KernelReceiveSpecific(void *msg, int pid, UserContext *uctxt) {
+    if (ValidUserRange(activePCB->user_page_table, msg, IPC_MESSAGE_SIZE, PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelReceive, invalid message buffer %p\n", msg);
+        return ERROR;
+    }
+    if (pid < 0 || pid == activePCB->pid || (pid > 0 && find_process(pid) == NULL)) {
+        TracePrintf(0, "ERROR: KernelReceive, invalid sender %d\n", pid);
+        return ERROR;
+    }
+
+    // take a waiting sender if there is one
+    pcb_t *sender;
+    if (pid == 0) sender = queue_pop(activePCB->senders);
+    else sender = queue_remove(activePCB->senders, pid);
+
+    if (sender != NULL) {
+        if (CopyFromProcess(sender, msg, sender->ipc_msg, IPC_MESSAGE_SIZE) == ERROR) {
+            sender->ipc_result = ERROR;
+            sender->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, sender, sender->pid);
+            return ERROR;
+        }
+        sender->blocked_code = BLOCKED_REPLY;
+        queue_add(blocked_q, sender, sender->pid);
+        return sender->pid;
+    }
+
+    // otherwise wait for a sender to copy its message straight into msg
+    activePCB->ipc_msg = msg;
+    activePCB->ipc_partner = pid;
+    activePCB->ipc_result = 0;
+    activePCB->blocked_code = BLOCKED_RECEIVE;
+    SwapProcess(blocked_q, uctxt);
+
+    if (activePCB->ipc_result == ERROR) return ERROR;
+    return activePCB->ipc_partner;
+}
+
+/**
+ * @brief Receives a message from any process
+ * 
+ * @param msg 
+ * @param uctxt 
+ * @return int pid of the sender, ERROR otherwise
+ */
+int KernelReceive(void *msg, UserContext *uctxt) {
+    return KernelReceiveSpecific(msg, 0, uctxt);
+}
+
+/**
+ * @brief Replies to pid, which must be blocked waiting on a reply from us,
+ * by copying msg over its original message and unblocking it
+ * 
+ * @param msg 
+ * @param pid 
+ * @return int 
+ */
+int KernelReply(void *msg, int pid) {
+    if (ValidUserRange(activePCB->user_page_table, msg, IPC_MESSAGE_SIZE, PROT_READ) == ERROR) {
+        TracePrintf(0, "ERROR: KernelReply, invalid message buffer %p\n", msg);
+        return ERROR;
+    }
+    pcb_t *sender = find_process(pid);
+    if (sender == NULL || sender->blocked_code != BLOCKED_REPLY || sender->ipc_partner != activePCB->pid) {
+        TracePrintf(0, "ERROR: KernelReply, %d is not waiting on a reply from us\n", pid);
+        return ERROR;
+    }
+    if (CopyToProcess(sender, sender->ipc_msg, msg, IPC_MESSAGE_SIZE) == ERROR) {
+        IpcWake(sender, ERROR);
+        return ERROR;
+    }
+    IpcWake(sender, 0);
+    return 0;
+}
+
+/**
+ * @brief Forwards msg to dest as if src had sent it. src must be blocked
+ * waiting on a reply from us, and will now wait on a reply from dest.
+ * 
+ * @param msg 
+ * @param dest 
+ * @param src 
+ * @return int 
+ */
+int KernelForward(void *msg, int dest, int src) {
+    if (ValidUserRange(activePCB->user_page_table, msg, IPC_MESSAGE_SIZE, PROT_READ) == ERROR) {
+        TracePrintf(0, "ERROR: KernelForward, invalid message buffer %p\n", msg);
+        return ERROR;
+    }
+    pcb_t *sender = find_process(src);
+    if (sender == NULL || sender->blocked_code != BLOCKED_REPLY || sender->ipc_partner != activePCB->pid) {
+        TracePrintf(0, "ERROR: KernelForward, %d is not waiting on a reply from us\n", src);
+        return ERROR;
+    }
+    pcb_t *receiver = IpcTarget(dest);
+    if (receiver == NULL || receiver == sender) {
+        IpcWake(sender, ERROR);
+        return ERROR;
+    }
+
+    // the forwarded message becomes src's message
+    if (CopyToProcess(sender, sender->ipc_msg, msg, IPC_MESSAGE_SIZE) == ERROR) {
+        IpcWake(sender, ERROR);
+        return ERROR;
+    }
+
+    int rc = IpcDeliver(sender, receiver, msg);
+    if (rc == ERROR) {
+        IpcWake(sender, ERROR);
+        return ERROR;
+    }
+    if (rc == 1) {
+        // move src from waiting on our reply to waiting on dest's Receive
+        queue_remove(blocked_q, sender->pid);
+        sender->blocked_code = BLOCKED_SEND;
+        queue_add(receiver->senders, sender, sender->pid);
+    }
+    return 0;
+}
+
+/**
+ * @brief Copies len bytes from src in the address space of srcpid to dest in ours.
+ * srcpid must be blocked waiting on a reply from us.
+ * 
+ * @param srcpid 
+ * @param dest 
+ * @param src 
+ * @param len 
+ * @return int 
+ */
+int KernelCopyFrom(int srcpid, void *dest, void *src, int len) {
+    pcb_t *client = find_process(srcpid);
+    if (client == NULL || client->blocked_code != BLOCKED_REPLY || client->ipc_partner != activePCB->pid) {
+        TracePrintf(0, "ERROR: KernelCopyFrom, %d is not waiting on a reply from us\n", srcpid);
+        return ERROR;
+    }
+    if (ValidUserRange(activePCB->user_page_table, dest, len, PROT_WRITE) == ERROR) {
+        TracePrintf(0, "ERROR: KernelCopyFrom, invalid destination %p\n", dest);
+        return ERROR;
+    }
+    return CopyFromProcess(client, dest, src, len);
+}
+
+/**
+ * @brief Copies len bytes from src in our address space to dest in the one of
+ * dstpid. dstpid must be blocked waiting on a reply from us.
+ * 
+ * @param dstpid 
+ * @param dest 
+ * @param src 
+ * @param len 
+ * @return int 
+ */
+int KernelCopyTo(int dstpid, void *dest, void *src, int len) {
+    pcb_t *client = find_process(dstpid);
+    if (client == NULL || client->blocked_code != BLOCKED_REPLY || client->ipc_partner != activePCB->pid) {
+        TracePrintf(0, "ERROR: KernelCopyTo, %d is not waiting on a reply from us\n", dstpid);
+        return ERROR;
+    }
+    if (ValidUserRange(activePCB->user_page_table, src, len, PROT_READ) == ERROR) {
+        TracePrintf(0, "ERROR: KernelCopyTo, invalid source %p\n", src);
+        return ERROR;
+    }
+    return CopyToProcess(client, dest, src, len);
+}
+
+/**
+ * @brief Drops the message passing state of an exiting process: its services
+ * are unregistered and anyone waiting on it is woken with ERROR
+ * 
+ * @param pcb the exiting process
+ */
+void IpcExit(pcb_t *pcb) {
+    list_remove(process_list, pcb, NULL);
+
+    for (int i = 0; i < MAX_SERVICES; i++) {
+        if (service_registry[i] == pcb->pid) service_registry[i] = NO_SERVICE;
+    }
+
+    // senders that never got received
+    pcb_t *sender;
+    while ((sender = queue_pop(pcb->senders)) != NULL) {
+        sender->ipc_result = ERROR;
+        sender->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, sender, sender->pid);
+    }
+
+    // clients we received from but never replied to, and receivers waiting
+    // on a message from us in particular
+    for (lnode_t *node = process_list->head; node != NULL; node = node->next) {
+        pcb_t *client = (pcb_t *) node->data;
+        if ((client->blocked_code == BLOCKED_REPLY || client->blocked_code == BLOCKED_RECEIVE) &&
+            client->ipc_partner == pcb->pid) {
+            IpcWake(client, ERROR);
+        }
+    }
 }
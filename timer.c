@@ -0,0 +1,73 @@
+/*
+ * timer.c
+ *
+ * timeouts for blocked processes, see timer.h
+ */
+
+#include <ylib.h>
+#include "timer.h"
+#include "kernel.h"
+#include "include.h"
+
+// armed processes, earliest deadline first, linked through timer_next
+static pcb_t *timer_head = NULL;
+
+/**
+ * @brief arms a timeout for pcb, which is about to block in wait_q
+ * 
+ * @param pcb 
+ * @param wait_q queue pcb blocks in
+ * @param deadline absolute clock tick
+ */
+void timer_arm(pcb_t *pcb, queue_t *wait_q, int deadline) {
+    if (pcb == NULL) return;
+    timer_cancel(pcb);
+
+    pcb->wait_q = wait_q;
+    pcb->deadline = deadline;
+    pcb->timed_out = 0;
+
+    // keep the list sorted, ties go in arming order
+    pcb_t **link = &timer_head;
+    while (*link != NULL && (*link)->deadline <= deadline) {
+        link = &(*link)->timer_next;
+    }
+    pcb->timer_next = *link;
+    *link = pcb;
+}
+
+/**
+ * @brief disarms pcb's timeout, if it has one
+ * 
+ * @param pcb 
+ */
+void timer_cancel(pcb_t *pcb) {
+    for (pcb_t **link = &timer_head; *link != NULL; link = &(*link)->timer_next) {
+        if (*link == pcb) {
+            *link = pcb->timer_next;
+            break;
+        }
+    }
+    pcb->timer_next = NULL;
+    pcb->wait_q = NULL;
+}
+
+/**
+ * @brief expires every timeout whose deadline has passed
+ */
+void timer_tick(void) {
+    while (timer_head != NULL && timer_head->deadline <= global_clock_ticks) {
+        pcb_t *pcb = timer_head;
+        timer_head = pcb->timer_next;
+        pcb->timer_next = NULL;
+
+        // whoever woke it first wins: only time out a process still waiting
+        if (pcb->wait_q != NULL && queue_remove(pcb->wait_q, pcb->pid) != NULL) {
+            TracePrintf(0, "timer_tick: process %d timed out\n", pcb->pid);
+            pcb->timed_out = 1;
+            pcb->blocked_code = NOT_BLOCKED;
+            queue_add(ready_q, pcb, pcb->pid);
+        }
+        pcb->wait_q = NULL;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef __TIMER_H_
+#define __TIMER_H_
+
+#include "process.h"
+#include "queue.h"
+
+/*
+ * timer.h
+ *
+ * deadlines for processes that block with a timeout. Armed processes are
+ * kept in a list sorted by deadline, so each clock tick only looks at the
+ * ones that actually expire.
+ */
+
+/**
+ * @brief arms a timeout for pcb, which is about to block in wait_q. If the
+ * clock reaches deadline while pcb is still in wait_q, it is taken out,
+ * marked timed_out and put on the ready queue
+ * 
+ * @param pcb 
+ * @param wait_q queue pcb blocks in
+ * @param deadline absolute clock tick
+ */
+void timer_arm(pcb_t *pcb, queue_t *wait_q, int deadline);
+
+/**
+ * @brief disarms pcb's timeout, if it has one
+ * 
+ * @param pcb 
+ */
+void timer_cancel(pcb_t *pcb);
+
+/**
+ * @brief expires every timeout whose deadline has passed, called on each
+ * clock tick
+ */
+void timer_tick(void);
+
+#endif
@@ -12,6 +12,8 @@
 #include "queue.h"
 #include "kernel.h"
 #include "traphandlers.h"
+#include "timer.h"
+#include "tty.h"
 
 
 void (*InterruptVectorTable[TRAP_VECTOR_SIZE]) (void *ctx);
@@ -49,6 +51,26 @@ void TrapKernelHandler(void *ctx) {
                 KernelExit(ERROR,uctxt);
             }
             
+            break;
+        case YALNIX_EXEC_CACHE_STATS:
+            TracePrintf(0, "kernel calling ExecCacheStats(%p)\n", regs[0]);
+            regs[0] = KernelExecCacheStats((exec_cache_stats_t *) regs[0]);
+            break;
+        case YALNIX_SPAWN:
+            TracePrintf(0, "kernel calling Spawn(%s, ...)\n", regs[0]);
+            regs[0] = KernelSpawn(uctxt, (char *) regs[0], (char **) regs[1]);
+            break;
+        case YALNIX_THREAD_CREATE:
+            TracePrintf(0, "kernel calling ThreadCreate(%p, %p)\n", regs[1], regs[2]);
+            regs[0] = KernelThreadCreate(uctxt, (void *) regs[0], (void *) regs[1], (void *) regs[2]);
+            break;
+        case YALNIX_THREAD_EXIT:
+            TracePrintf(0, "kernel calling ThreadExit(%d)\n", (int) regs[0]);
+            KernelThreadExit((int) regs[0], uctxt);
+            break;
+        case YALNIX_THREAD_JOIN:
+            TracePrintf(0, "kernel calling ThreadJoin(%d, %p)\n", (int) regs[0], regs[1]);
+            regs[0] = KernelThreadJoin((int) regs[0], (int *) regs[1], uctxt);
             break;
         case YALNIX_EXIT:
             TracePrintf(0, "kernel calling Exit(%d)\n", (int) regs[0]);
@@ -58,6 +80,10 @@ void TrapKernelHandler(void *ctx) {
             TracePrintf(0, "kernel calling Wait()\n");
             regs[0] = KernelWait((int *) regs[0],ctx);
             break;
+        case YALNIX_WAIT_PID:
+            TracePrintf(0, "kernel calling WaitPid(%d, %p, %d)\n", (int) regs[0], regs[1], (int) regs[2]);
+            regs[0] = KernelWaitPid((int) regs[0], (int *) regs[1], (int) regs[2], uctxt);
+            break;
         case YALNIX_GETPID:
             TracePrintf(0, "kernel calling GetPid()\n");
             regs[0] = KernelGetPid();
@@ -78,6 +104,18 @@ void TrapKernelHandler(void *ctx) {
             TracePrintf(0, "kernel calling TtyRead(uctxt, %d, %p, %d)\n", (int) regs[0], (void *) regs[1], (int) regs[2]);
             regs[0] = KernelTtyRead(ctx, (int) regs[0], (void *) regs[1], (int) regs[2]);
             break;
+        case YALNIX_TTY_READ_TIMEOUT:
+            TracePrintf(0, "kernel calling TtyReadTimeout(%d, %p, %d, %d)\n", (int) regs[0], (void *) regs[1], (int) regs[2], (int) regs[3]);
+            regs[0] = KernelTtyReadTimeout(ctx, (int) regs[0], (void *) regs[1], (int) regs[2], (int) regs[3]);
+            break;
+        case YALNIX_TTY_SET_MODE:
+            TracePrintf(0, "kernel calling TtySetMode(%d, %d, %d)\n", (int) regs[0], (int) regs[1], (int) regs[2]);
+            regs[0] = KernelTtySetMode((int) regs[0], (int) regs[1], (int) regs[2]);
+            break;
+        case YALNIX_TTY_WRITE_STATS:
+            TracePrintf(0, "kernel calling TtyWriteStats(%d, %p)\n", (int) regs[0], regs[1]);
+            regs[0] = KernelTtyWriteStats((int) regs[0], (tty_write_stats_t *) regs[1]);
+            break;
         case YALNIX_TTY_WRITE:
             TracePrintf(0, "kernel calling TtyWrite(uctxt, %d, %p, %d)\n", (int) regs[0], (void *) regs[1], (int) regs[2]);
             regs[0] = KernelTtyWrite(ctx, (int) regs[0], (void *) regs[1], (int) regs[2]);
@@ -110,6 +148,14 @@ void TrapKernelHandler(void *ctx) {
             TracePrintf(0, "kernel calling yalnix cvar wait\n");
             regs[0] = KernelCvarWait(regs[0], regs[1], ctx);
             break;
+        case YALNIX_CVAR_WAIT_TIMEOUT:
+            TracePrintf(0, "kernel calling CvarWaitTimeout(%d, %d, %d)\n", (int) regs[0], (int) regs[1], (int) regs[2]);
+            regs[0] = KernelCvarWaitTimeout((int) regs[0], (int) regs[1], (int) regs[2], ctx);
+            break;
+        case YALNIX_PIPE_READ_TIMEOUT:
+            TracePrintf(0, "kernel calling PipeReadTimeout(%d, %p, %d, %d)\n", (int) regs[0], regs[1], (int) regs[2], (int) regs[3]);
+            regs[0] = KernelPipeReadTimeout((int) regs[0], (void *) regs[1], (int) regs[2], (int) regs[3], ctx);
+            break;
         case YALNIX_LOCK_INIT:
             TracePrintf(0, "kernel calling yalnix lock init\n");
             regs[0] = KernelLockInit((int *)regs[0]);
@@ -118,19 +164,206 @@ void TrapKernelHandler(void *ctx) {
             TracePrintf(0, "kernel calling yalnix lock acquire\n");
             regs[0] = KernelAcquire(regs[0], ctx);
             break;
+        case YALNIX_LOCK_TRY_ACQUIRE:
+            TracePrintf(0, "kernel calling TryAcquire(%d)\n", (int) regs[0]);
+            regs[0] = KernelTryAcquire((int) regs[0], ctx);
+            break;
+        case YALNIX_LOCK_ACQUIRE_TIMEOUT:
+            TracePrintf(0, "kernel calling AcquireTimeout(%d, %d)\n", (int) regs[0], (int) regs[1]);
+            regs[0] = KernelAcquireTimeout((int) regs[0], (int) regs[1], ctx);
+            break;
+        case YALNIX_LOCK_STATS:
+            TracePrintf(0, "kernel calling LockStats(%d, %p)\n", (int) regs[0], regs[1]);
+            regs[0] = KernelLockStats((int) regs[0], (lock_stats_t *) regs[1]);
+            break;
+        case YALNIX_RWLOCK_INIT:
+            TracePrintf(0, "kernel calling RWLockInit(%p)\n", regs[0]);
+            regs[0] = KernelRWLockInit((int *) regs[0]);
+            break;
+        case YALNIX_RWLOCK_READ:
+            TracePrintf(0, "kernel calling RWLockRead(%d)\n", (int) regs[0]);
+            regs[0] = KernelRWLockRead((int) regs[0], ctx);
+            break;
+        case YALNIX_RWLOCK_WRITE:
+            TracePrintf(0, "kernel calling RWLockWrite(%d)\n", (int) regs[0]);
+            regs[0] = KernelRWLockWrite((int) regs[0], ctx);
+            break;
+        case YALNIX_RWLOCK_RELEASE:
+            TracePrintf(0, "kernel calling RWLockRelease(%d)\n", (int) regs[0]);
+            regs[0] = KernelRWLockRelease((int) regs[0]);
+            break;
         case YALNIX_LOCK_RELEASE:
             TracePrintf(0, "kernel calling yalnix lock release\n");
             regs[0] = KernelRelease(regs[0]);
             break;
+        case YALNIX_SEM_INIT:
+            TracePrintf(0, "kernel calling SemInit(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelSemInit((int *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_SEM_UP:
+            TracePrintf(0, "kernel calling SemUp(%d)\n", (int) regs[0]);
+            regs[0] = KernelSemUp((int) regs[0], 1);
+            break;
+        case YALNIX_SEM_UP_N:
+            TracePrintf(0, "kernel calling SemUpN(%d, %d)\n", (int) regs[0], (int) regs[1]);
+            regs[0] = KernelSemUp((int) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_SEM_DOWN:
+            TracePrintf(0, "kernel calling SemDown(%d)\n", (int) regs[0]);
+            regs[0] = KernelSemDown((int) regs[0], 1, ctx);
+            break;
+        case YALNIX_SEM_DOWN_N:
+            TracePrintf(0, "kernel calling SemDownN(%d, %d)\n", (int) regs[0], (int) regs[1]);
+            regs[0] = KernelSemDown((int) regs[0], (int) regs[1], ctx);
+            break;
+        case YALNIX_SEM_TRY_DOWN:
+            TracePrintf(0, "kernel calling SemTryDown(%d)\n", (int) regs[0]);
+            regs[0] = KernelSemTryDown((int) regs[0]);
+            break;
+        case YALNIX_BARRIER_INIT:
+            TracePrintf(0, "kernel calling BarrierInit(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelBarrierInit((int *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_BARRIER_WAIT:
+            TracePrintf(0, "kernel calling BarrierWait(%d)\n", (int) regs[0]);
+            regs[0] = KernelBarrierWait((int) regs[0], ctx);
+            break;
         case YALNIX_RECLAIM:
             TracePrintf(0, "kernel calling yalnix reclaim\n");
             regs[0] = KernelReclaim(regs[0]);
             break;
+        case YALNIX_SHM_INIT:
+            TracePrintf(0, "kernel calling ShmInit(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelShmInit((int *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_SHM_ATTACH:
+            TracePrintf(0, "kernel calling ShmAttach(%d, %p)\n", (int) regs[0], regs[1]);
+            regs[0] = KernelShmAttach((int) regs[0], (void **) regs[1]);
+            break;
+        case YALNIX_SHM_DETACH:
+            TracePrintf(0, "kernel calling ShmDetach(%p)\n", regs[0]);
+            regs[0] = KernelShmDetach((void *) regs[0]);
+            break;
+        case YALNIX_FUTEX_WAIT:
+            TracePrintf(0, "kernel calling FutexWait(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelFutexWait((int *) regs[0], (int) regs[1], ctx);
+            break;
+        case YALNIX_FUTEX_WAKE:
+            TracePrintf(0, "kernel calling FutexWake(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelFutexWake((int *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_POLL:
+            TracePrintf(0, "kernel calling Poll(%p, %d, %d)\n", regs[0], (int) regs[1], (int) regs[2]);
+            regs[0] = KernelPoll((poll_entry_t *) regs[0], (int) regs[1], (int) regs[2], ctx);
+            break;
+        case YALNIX_RING_SETUP:
+            TracePrintf(0, "kernel calling RingSetup(%p)\n", regs[0]);
+            regs[0] = KernelRingSetup((ring_t **) regs[0]);
+            break;
+        case YALNIX_RING_ENTER:
+            TracePrintf(0, "kernel calling RingEnter(%d)\n", (int) regs[0]);
+            regs[0] = KernelRingEnter((int) regs[0], ctx);
+            break;
+        case YALNIX_PIPE_READV:
+            TracePrintf(0, "kernel calling PipeReadv(%d, %p, %d)\n", (int) regs[0], regs[1], (int) regs[2]);
+            regs[0] = KernelPipeReadv((int) regs[0], (io_vec_t *) regs[1], (int) regs[2], ctx);
+            break;
+        case YALNIX_PIPE_WRITEV:
+            TracePrintf(0, "kernel calling PipeWritev(%d, %p, %d)\n", (int) regs[0], regs[1], (int) regs[2]);
+            regs[0] = KernelPipeWritev((int) regs[0], (io_vec_t *) regs[1], (int) regs[2], ctx);
+            break;
+        case YALNIX_TTY_WRITEV:
+            TracePrintf(0, "kernel calling TtyWritev(%d, %p, %d)\n", (int) regs[0], regs[1], (int) regs[2]);
+            regs[0] = KernelTtyWritev(ctx, (int) regs[0], (io_vec_t *) regs[1], (int) regs[2]);
+            break;
+        case YALNIX_PIPE_LOWAT:
+            TracePrintf(0, "kernel calling PipeSetLowat(%d, %d, %d)\n", (int) regs[0], (int) regs[1], (int) regs[2]);
+            regs[0] = KernelPipeSetLowat((int) regs[0], (int) regs[1], (int) regs[2]);
+            break;
+        case YALNIX_BCAST_INIT:
+            TracePrintf(0, "kernel calling BcastInit(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelBcastInit((int *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_BCAST_SUBSCRIBE:
+            TracePrintf(0, "kernel calling BcastSubscribe(%d)\n", (int) regs[0]);
+            regs[0] = KernelBcastSubscribe((int) regs[0]);
+            break;
+        case YALNIX_BCAST_UNSUBSCRIBE:
+            TracePrintf(0, "kernel calling BcastUnsubscribe(%d)\n", (int) regs[0]);
+            regs[0] = KernelBcastUnsubscribe((int) regs[0]);
+            break;
+        case YALNIX_BCAST_WRITE:
+            TracePrintf(0, "kernel calling BcastWrite(%d, %p, %d)\n", (int) regs[0], regs[1], (int) regs[2]);
+            regs[0] = KernelBcastWrite((int) regs[0], (void *) regs[1], (int) regs[2], ctx);
+            break;
+        case YALNIX_BCAST_READ:
+            TracePrintf(0, "kernel calling BcastRead(%d, %p, %d)\n", (int) regs[0], regs[1], (int) regs[2]);
+            regs[0] = KernelBcastRead((int) regs[0], (void *) regs[1], (int) regs[2], ctx);
+            break;
+        case YALNIX_BCAST_LOST:
+            TracePrintf(0, "kernel calling BcastLost(%d)\n", (int) regs[0]);
+            regs[0] = KernelBcastLost((int) regs[0]);
+            break;
+        case YALNIX_MSGQ_INIT:
+            TracePrintf(0, "kernel calling MsgqInit(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelMsgqInit((int *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_MSGQ_SEND:
+            TracePrintf(0, "kernel calling MsgqSend(%d, %p, %d, %d)\n", (int) regs[0], regs[1], (int) regs[2], (int) regs[3]);
+            regs[0] = KernelMsgqSend((int) regs[0], (void *) regs[1], (int) regs[2], (int) regs[3], ctx);
+            break;
+        case YALNIX_MSGQ_RECEIVE:
+            TracePrintf(0, "kernel calling MsgqReceive(%d, %p, %d, %p)\n", (int) regs[0], regs[1], (int) regs[2], regs[3]);
+            regs[0] = KernelMsgqReceive((int) regs[0], (void *) regs[1], (int) regs[2], (int *) regs[3], ctx);
+            break;
+        case YALNIX_SPLICE:
+            TracePrintf(0, "kernel calling Splice(%d, %d)\n", (int) regs[0], (int) regs[1]);
+            regs[0] = KernelSplice((int) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_TEE:
+            TracePrintf(0, "kernel calling Tee(%d, %d)\n", (int) regs[0], (int) regs[1]);
+            regs[0] = KernelTee((int) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_REGISTER:
+            TracePrintf(0, "kernel calling Register(%d)\n", regs[0]);
+            regs[0] = KernelRegister((unsigned int) regs[0]);
+            break;
+        case YALNIX_SEND:
+            TracePrintf(0, "kernel calling Send(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelSend((void *) regs[0], (int) regs[1], ctx);
+            break;
+        case YALNIX_RECEIVE:
+            TracePrintf(0, "kernel calling Receive(%p)\n", regs[0]);
+            regs[0] = KernelReceive((void *) regs[0], ctx);
+            break;
+        case YALNIX_RECEIVESPECIFIC:
+            TracePrintf(0, "kernel calling ReceiveSpecific(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelReceiveSpecific((void *) regs[0], (int) regs[1], ctx);
+            break;
+        case YALNIX_REPLY:
+            TracePrintf(0, "kernel calling Reply(%p, %d)\n", regs[0], (int) regs[1]);
+            regs[0] = KernelReply((void *) regs[0], (int) regs[1]);
+            break;
+        case YALNIX_FORWARD:
+            TracePrintf(0, "kernel calling Forward(%p, %d, %d)\n", regs[0], (int) regs[1], (int) regs[2]);
+            regs[0] = KernelForward((void *) regs[0], (int) regs[1], (int) regs[2]);
+            break;
+        case YALNIX_COPY_FROM:
+            TracePrintf(0, "kernel calling CopyFrom(%d, %p, %p, %d)\n", (int) regs[0], regs[1], regs[2], (int) regs[3]);
+            regs[0] = KernelCopyFrom((int) regs[0], (void *) regs[1], (void *) regs[2], (int) regs[3]);
+            break;
+        case YALNIX_COPY_TO:
+            TracePrintf(0, "kernel calling CopyTo(%d, %p, %p, %d)\n", (int) regs[0], regs[1], regs[2], (int) regs[3]);
+            regs[0] = KernelCopyTo((int) regs[0], (void *) regs[1], (void *) regs[2], (int) regs[3]);
+            break;
 
         default:
             TracePrintf(0, "Unknown code\n");
             break;
     }
+
+    // a thread whose process exited ends instead of returning to user code
+    if (activePCB->thread_killed) KernelThreadExit(ERROR, uctxt);
     // check code of uctxt
 
     // depending on code, call the corresponding function below
@@ -147,17 +380,12 @@ void TrapKernelHandler(void *ctx) {
  */
 void TrapClockHandler(void *ctx) {
     TracePrintf(0, "Clock Tick -> %d\n", global_clock_ticks);
-    TracePrintf(0, "Ready -> %d ::: Blocked -> %d ::: Defunct -> %d ::: TtyRead %d ::: TtyWrite %d\n", ready_q->size, blocked_q->size, defunct_q->size, ttyReadQueues[0]->size, ttyWriteQueues[0]->size);
+    TracePrintf(0, "Ready -> %d ::: Blocked -> %d ::: TtyRead %d ::: TtyWrite %d\n", ready_q->size, blocked_q->size, ttyReadQueues[0]->size, ttyWriteQueues[0]->size);
     global_clock_ticks++;
+    timer_tick();
     // if (ready_q->size > 0) { 
     SwapProcess(ready_q,(UserContext *)ctx);
     // }
-    int limit = blocked_q->size;
-    for (int i = 0; i < limit; i++) {
-       pcb_t *pcb = queue_pop(blocked_q);
-       if (pcb != NULL) queue_add(CheckBlocked(pcb), pcb, pcb->pid);
-    }
-   
 }
 
 /**
@@ -174,11 +402,9 @@ void TrapIllegalHandler(void *ctx) {
         return;
     }
 
-    // set error code
-    activePCB->exit_code = ERROR;
-
-    // move process to defunct queue
-    SwapProcess(defunct_q, user_context);
+    // exit with an error code; a thread exits for ThreadJoin, a process
+    // waits in its parent's zombies queue
+    KernelExit(ERROR, user_context);
 }
 
 /**
@@ -207,6 +433,13 @@ void TrapMemoryHandler(void *ctx) {
         return;
     }
 
+    // thread stacks don't grow, running off one kills the thread
+    if (activePCB->thread_stack_pg > 0) {
+        TracePrintf(0, "Thread %d ran off its stack or made a bad access.\n", activePCB->pid);
+        KernelThreadExit(ERROR, user_context);
+        return;
+    }
+
     // get indexes for the user page base and stack index
     int user_page_base = VMEM_1_BASE >> PAGESHIFT;
     int stack_index = activePCB->user_stack_pt_index;
@@ -255,11 +488,9 @@ void TrapMathHandler(void *ctx) {
         return;
     }
 
-    // give an error exit code
-    activePCB->exit_code = ERROR;
-
-    // move process to defunct queue
-    SwapProcess(defunct_q, user_context);
+    // exit with an error code; a thread exits for ThreadJoin, a process
+    // waits in its parent's zombies queue
+    KernelExit(ERROR, user_context);
 }
 
 /**
@@ -271,39 +502,21 @@ void TrapTTYReceiveHandler(void *ctx) {
     UserContext *uctxt = (UserContext *) ctx;
 
     int tty_id = uctxt->code;
-    // buffers to store for each terminal
-    char *ttyBuffer = ttyReadbuffers[tty_id];
     queue_t *ttyQueue = ttyReadQueues[tty_id];
-
-    // clear stale bytes from the buffer
-    // memset(ttyBuffer, 0, TERMINAL_MAX_LINE);
     char tempBuffer[TERMINAL_MAX_LINE];
 
-    // use hardware function to read into a temporary buffer
+    // use hardware function to read into a temporary buffer, then keep as
+    // much as the terminal's input ring has room for
     int bytes = TtyReceive(tty_id, tempBuffer, TERMINAL_MAX_LINE);
-    int to_copy;
-
-    // if we have space in our buffer
-    if (TERMINAL_MAX_LINE - ttyReadTrackers[tty_id] < bytes) {
-
-        // set bytes to copy to be the current space we have left
-        to_copy = TERMINAL_MAX_LINE - ttyReadTrackers[tty_id];
-    } else {
-        // write all that we can
-        to_copy = bytes;
-    }
-
-    memcpy(ttyBuffer + ttyReadTrackers[tty_id], tempBuffer, to_copy);
+    int to_copy = tty_input_put(tty_id, tempBuffer, bytes);
 
-    // update readtrackers
-    ttyReadTrackers[tty_id] = ttyReadTrackers[tty_id] + to_copy;
-
-    // if anyone else if waiting to read, wake them up
-    if (ttyQueue->size > 0) {
+    // if anyone is waiting to read and there's something for them, wake the first
+    if (ttyQueue->size > 0 && tty_input_ready(tty_id) > 0) {
         pcb_t *nextReader = queue_pop(ttyQueue);
         nextReader->blocked_code = NOT_BLOCKED;
         queue_add(ready_q, nextReader, nextReader->pid);
     }
+    if (to_copy > 0) PollWake(POLL_TTY_READ);
 }
 
 /**
@@ -317,17 +530,22 @@ void TrapTTYTransmitHandler(void *ctx) {
     UserContext *uctxt = (UserContext *) ctx;
     int tty_id = uctxt->code;
 
-    // mark the terminal as available
-    ttyWriteTrackers[tty_id] = TERMINAL_OPEN;
+    // retire what just went out and start on the rest of the output ring
+    tty_output_done(tty_id);
 
     // check the queue of processes waiting to write
     queue_t *ttyQueue = ttyWriteQueues[tty_id];
     pcb_t *pcb = queue_peek(ttyQueue);
 
-    // wake the first one up if it isn't the active process
-    // ( put it into ready queue )
-    if (ttyQueue->size > 0 && activePCB->pid != pcb->pid) {
-        queue_add(CheckBlocked(pcb), pcb, pcb->pid);
+    // the writer at the head was waiting for room, which there is now
+    if (pcb != NULL && pcb->blocked_code == BLOCKED_TTY_WRITE && activePCB->pid != pcb->pid) {
+        pcb->blocked_code = NOT_BLOCKED;
+        queue_add(ready_q, pcb, pcb->pid);
+    }
+    // otherwise keep a spliced pipe flowing
+    else if (ttyQueue->size == 0) {
+        SpliceTtyReady(tty_id);
+        PollWake(POLL_TTY_WRITE);
     }
 }
 
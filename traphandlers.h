@@ -94,6 +94,54 @@ int KernelFork(UserContext *uctxt);
  */
 int KernelExec(UserContext *uctxt, char *filename, char **argvec);
 
+/**
+ * @brief Copies out the exec image cache's counters
+ * 
+ * @param statsp 
+ * @return int 
+ */
+int KernelExecCacheStats(exec_cache_stats_t *statsp);
+
+/**
+ * @brief Starts a child running filename without copying the caller
+ * 
+ * @param uctxt 
+ * @param filename 
+ * @param argvec 
+ * @return int child's pid to the caller, 0 in the child, ERROR on failure
+ */
+int KernelSpawn(UserContext *uctxt, char *filename, char **argvec);
+
+/**
+ * @brief Starts a thread running start(func, arg) in our address space
+ * 
+ * @param uctxt 
+ * @param start 
+ * @param func 
+ * @param arg 
+ * @return int thread's pid to the caller, 0 in the thread, ERROR on failure
+ */
+int KernelThreadCreate(UserContext *uctxt, void *start, void *func, void *arg);
+
+/**
+ * @brief Ends the calling thread, Exit if called from a process
+ * 
+ * @param exit_code 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelThreadExit(int exit_code, UserContext *uctxt);
+
+/**
+ * @brief Waits for a thread of our process to exit and collects it
+ * 
+ * @param tid 
+ * @param status_ptr 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelThreadJoin(int tid, int *status_ptr, UserContext *uctxt);
+
 /**
  * @brief 
  * 
@@ -109,6 +157,17 @@ int KernelExit(int exit_code, UserContext *uctxt);
  */
 int KernelWait(int *status_ptr, UserContext *uctxt);
 
+/**
+ * @brief Waits for one child, or any, optionally without blocking
+ * 
+ * @param pid child to wait for, WAIT_ANY for any
+ * @param status_ptr may be NULL
+ * @param flags WAIT_NOHANG or 0
+ * @param uctxt 
+ * @return int the child's pid, WOULD_BLOCK, or ERROR
+ */
+int KernelWaitPid(int pid, int *status_ptr, int flags, UserContext *uctxt);
+
 /**
  * @brief Get the Pid object
  * 
@@ -150,6 +209,40 @@ int KernelDelay(int clock_ticks, UserContext *uctxt);
  */
 int KernelTtyRead(UserContext *uctxt, int tty_id, void *buf, int len);
 
+/**
+ * @brief Reads from the terminal without waiting (ticks 0) or waiting at
+ * most ticks clock ticks for input
+ * 
+ * @param uctxt 
+ * @param tty_id 
+ * @param buf 
+ * @param len 
+ * @param ticks 
+ * @return int bytes read, 0 if ticks is 0 and there's nothing to read,
+ * TIMED_OUT or ERROR
+ */
+int KernelTtyReadTimeout(UserContext *uctxt, int tty_id, void *buf, int len, int ticks);
+
+/**
+ * @brief Switches a terminal between cooked and raw input, and resizes its
+ * input buffer unless capacity is 0
+ * 
+ * @param tty_id 
+ * @param mode TTY_COOKED or TTY_RAW
+ * @param capacity 
+ * @return int 
+ */
+int KernelTtySetMode(int tty_id, int mode, int capacity);
+
+/**
+ * @brief Copies out the caller's TtyWrite counters for a terminal
+ * 
+ * @param tty_id 
+ * @param statsp 
+ * @return int 
+ */
+int KernelTtyWriteStats(int tty_id, tty_write_stats_t *statsp);
+
 /**
  * @brief 
  * 
@@ -161,6 +254,17 @@ int KernelTtyRead(UserContext *uctxt, int tty_id, void *buf, int len);
  */
 int KernelTtyWrite(UserContext *uctxt, int tty_id, void *buf, int len);
 
+/**
+ * @brief Writes the segments of iov to the terminal as one write
+ * 
+ * @param uctxt
+ * @param tty_id 
+ * @param iov 
+ * @param iovcnt 
+ * @return int bytes written, ERROR otherwise
+ */
+int KernelTtyWritev(UserContext *uctxt, int tty_id, io_vec_t *iov, int iovcnt);
+
 /**
  * @brief 
  * 
@@ -179,6 +283,29 @@ int KernelPipeInit(int *pipe_idp);
  */
 int KernelPipeRead(int pipe_id, void *buf, int len,UserContext *uctxt);
 
+/**
+ * @brief Reads from the pipe, giving up if it stays empty for ticks clock ticks
+ * 
+ * @param pipe_id 
+ * @param buf 
+ * @param len 
+ * @param ticks 
+ * @param uctxt 
+ * @return int bytes read, TIMED_OUT or ERROR
+ */
+int KernelPipeReadTimeout(int pipe_id, void *buf, int len, int ticks, UserContext *uctxt);
+
+/**
+ * @brief Reads from the pipe into the segments of iov, filling each in turn
+ * 
+ * @param pipe_id 
+ * @param iov 
+ * @param iovcnt 
+ * @param uctxt
+ * @return int bytes read, ERROR otherwise
+ */
+int KernelPipeReadv(int pipe_id, io_vec_t *iov, int iovcnt, UserContext *uctxt);
+
 /**
  * @brief 
  * 
@@ -189,6 +316,53 @@ int KernelPipeRead(int pipe_id, void *buf, int len,UserContext *uctxt);
  */
 int KernelPipeWrite(int pipe_id, void *buf, int len, UserContext *uctxt);
 
+/**
+ * @brief Sets how many bytes readers of the pipe wait for, and for how long
+ * 
+ * @param pipe_id 
+ * @param min_bytes 
+ * @param ticks 0 to wait for min_bytes however long it takes
+ * @return int 
+ */
+int KernelPipeSetLowat(int pipe_id, int min_bytes, int ticks);
+
+/**
+ * @brief Connects the pipe's output to a terminal or another pipe, moving
+ * its bytes inside the kernel as they arrive
+ * 
+ * @param pipe_id 
+ * @param dest_id terminal number, pipe id, or NO_SPLICE to disconnect
+ * @return int 
+ */
+int KernelSplice(int pipe_id, int dest_id);
+
+/**
+ * @brief Copies every byte written to the pipe into a second pipe too
+ * 
+ * @param pipe_id 
+ * @param copy_id pipe id, or NO_SPLICE to stop
+ * @return int 
+ */
+int KernelTee(int pipe_id, int copy_id);
+
+/**
+ * @brief Sends the next line of the pipe spliced to an idle terminal
+ * 
+ * @param tty_id 
+ */
+void SpliceTtyReady(int tty_id);
+
+/**
+ * @brief Writes the segments of iov into the pipe back to back, as one write
+ * 
+ * @param pipe_id 
+ * @param iov 
+ * @param iovcnt 
+ * @param uctxt
+ * @return int bytes written, ERROR otherwise
+ */
+int KernelPipeWritev(int pipe_id, io_vec_t *iov, int iovcnt, UserContext *uctxt);
+
 /**
  * @brief 
  * 
@@ -214,6 +388,68 @@ int KernelAcquire(int lock_id, UserContext *uctxt);
  */
 int KernelRelease(int lock_id);
 
+/**
+ * @brief Takes the lock only if it's free
+ * 
+ * @param lock_id 
+ * @param uctxt 
+ * @return int SUCCESS, WOULD_BLOCK if it's held, ERROR otherwise
+ */
+int KernelTryAcquire(int lock_id, UserContext *uctxt);
+
+/**
+ * @brief Takes the lock, giving up after ticks clock ticks
+ * 
+ * @param lock_id 
+ * @param ticks 
+ * @param uctxt 
+ * @return int SUCCESS, TIMED_OUT, or ERROR
+ */
+int KernelAcquireTimeout(int lock_id, int ticks, UserContext *uctxt);
+
+/**
+ * @brief Copies the lock's counters out
+ * 
+ * @param lock_id 
+ * @param statsp 
+ * @return int 
+ */
+int KernelLockStats(int lock_id, lock_stats_t *statsp);
+
+/**
+ * @brief Creates a reader-writer lock, taking its id from the lock ids
+ * 
+ * @param lock_idp 
+ * @return int 
+ */
+int KernelRWLockInit(int *lock_idp);
+
+/**
+ * @brief Takes a read hold, waiting while a writer holds or waits for the lock
+ * 
+ * @param lock_id 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelRWLockRead(int lock_id, UserContext *uctxt);
+
+/**
+ * @brief Takes the lock for writing, waiting until nobody holds it
+ * 
+ * @param lock_id 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelRWLockWrite(int lock_id, UserContext *uctxt);
+
+/**
+ * @brief Drops the caller's write hold or one read hold
+ * 
+ * @param lock_id 
+ * @return int 
+ */
+int KernelRWLockRelease(int lock_id);
+
 
 /**
  * @brief 
@@ -251,6 +487,71 @@ int KernelCvarBroadcast(int cvar_idp, UserContext *uctxt);
  */
 int KernelCvarWait(int cvar_idp, int lock_id, UserContext *uctxt);
 
+/**
+ * @brief Waits on the cvar for at most ticks clock ticks
+ * 
+ * @param cvar_idp 
+ * @param lock_id 
+ * @param ticks 
+ * @param uctxt 
+ * @return int SUCCESS, TIMED_OUT or ERROR; the lock is held again either way
+ */
+int KernelCvarWaitTimeout(int cvar_idp, int lock_id, int ticks, UserContext *uctxt);
+
+/**
+ * @brief Creates a counting semaphore with the given initial value
+ * 
+ * @param sem_idp where the id of the semaphore is saved
+ * @param value 
+ * @return int 
+ */
+int KernelSemInit(int *sem_idp, int value);
+
+/**
+ * @brief Adds n to the semaphore, waking waiters whose requests now fit
+ * 
+ * @param sem_id 
+ * @param n 
+ * @return int 
+ */
+int KernelSemUp(int sem_id, int n);
+
+/**
+ * @brief Takes n from the semaphore, blocking until n are available
+ * 
+ * @param sem_id 
+ * @param n 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelSemDown(int sem_id, int n, UserContext *uctxt);
+
+/**
+ * @brief Takes 1 from the semaphore if that can be done without blocking
+ * 
+ * @param sem_id 
+ * @return int 0 if taken, WOULD_BLOCK if not, ERROR otherwise
+ */
+int KernelSemTryDown(int sem_id);
+
+/**
+ * @brief Creates a barrier for the given number of processes
+ * 
+ * @param barrier_idp where the id of the barrier is saved
+ * @param parties 
+ * @return int 
+ */
+int KernelBarrierInit(int *barrier_idp, int parties);
+
+/**
+ * @brief Blocks until every party has reached the barrier
+ * 
+ * @param barrier_id 
+ * @param uctxt 
+ * @return int BARRIER_SERIAL for the last to arrive, 0 for the rest, ERROR otherwise
+ */
+int KernelBarrierWait(int barrier_id, UserContext *uctxt);
+
 /**
  * @brief 
  * 
@@ -260,4 +561,260 @@ int KernelCvarWait(int cvar_idp, int lock_id, UserContext *uctxt);
 int KernelReclaim(int id);
 
 
+/**
+ * @brief Creates a shared memory segment of npages pages
+ * 
+ * @param shm_idp where the id of the segment is saved
+ * @param npages 
+ * @return int 
+ */
+int KernelShmInit(int *shm_idp, int npages);
+
+/**
+ * @brief Maps a shared memory segment into the caller's region 1
+ * 
+ * @param shm_id 
+ * @param addrp where the address of the mapping is saved
+ * @return int 
+ */
+int KernelShmAttach(int shm_id, void **addrp);
+
+/**
+ * @brief Unmaps the shared memory segment mapped at addr
+ * 
+ * @param addr 
+ * @return int 
+ */
+int KernelShmDetach(void *addr);
+
+/**
+ * @brief Blocks the caller on addr if *addr still equals val
+ * 
+ * @param addr 
+ * @param val 
+ * @param uctxt 
+ * @return int 0 once woken, WOULD_BLOCK if *addr != val, ERROR otherwise
+ */
+int KernelFutexWait(int *addr, int val, UserContext *uctxt);
+
+/**
+ * @brief Wakes up to n processes blocked in FutexWait on addr
+ * 
+ * @param addr 
+ * @param n 
+ * @return int number of processes woken, ERROR otherwise
+ */
+int KernelFutexWake(int *addr, int n);
+
+/**
+ * @brief Blocks until one of the entries is ready or timeout ticks pass
+ * 
+ * @param entries 
+ * @param nentries 
+ * @param timeout ticks, 0 to only check, -1 for no timeout
+ * @param uctxt 
+ * @return int number of ready entries, 0 on timeout, ERROR otherwise
+ */
+int KernelPoll(poll_entry_t *entries, int nentries, int timeout, UserContext *uctxt);
+
+/**
+ * @brief Wakes every process in Poll waiting on any of the kinds in events,
+ * so it can recheck its entries
+ * 
+ * @param events POLL_* mask
+ */
+void PollWake(int events);
+
+/**
+ * @brief Creates a broadcast channel
+ * 
+ * @param bcast_idp where the id is saved
+ * @param policy BCAST_BLOCK or BCAST_DROP
+ * @return int 
+ */
+int KernelBcastInit(int *bcast_idp, int policy);
+
+/**
+ * @brief Subscribes the caller to the channel, from the next byte written
+ * 
+ * @param bcast_id 
+ * @return int 
+ */
+int KernelBcastSubscribe(int bcast_id);
+
+/**
+ * @brief Drops the caller's subscription to the channel
+ * 
+ * @param bcast_id 
+ * @return int 
+ */
+int KernelBcastUnsubscribe(int bcast_id);
+
+/**
+ * @brief Appends len bytes to the channel for every subscriber
+ * 
+ * @param bcast_id 
+ * @param buf 
+ * @param len 
+ * @param uctxt 
+ * @return int bytes written, ERROR otherwise
+ */
+int KernelBcastWrite(int bcast_id, void *buf, int len, UserContext *uctxt);
+
+/**
+ * @brief Reads up to len of the caller's unread bytes, blocking until there
+ * are some
+ * 
+ * @param bcast_id 
+ * @param buf 
+ * @param len 
+ * @param uctxt 
+ * @return int bytes read, ERROR otherwise
+ */
+int KernelBcastRead(int bcast_id, void *buf, int len, UserContext *uctxt);
+
+/**
+ * @brief Returns and clears how many bytes the caller missed
+ * 
+ * @param bcast_id 
+ * @return int 
+ */
+int KernelBcastLost(int bcast_id);
+
+/**
+ * @brief Creates a message queue
+ * 
+ * @param msgq_idp where the id is saved
+ * @param max_bytes bound on queued bytes, 0 for the default
+ * @return int 
+ */
+int KernelMsgqInit(int *msgq_idp, int max_bytes);
+
+/**
+ * @brief Queues a copy of the message, waiting only if it doesn't fit
+ * 
+ * @param msgq_id 
+ * @param buf 
+ * @param len 
+ * @param prio higher is delivered first
+ * @param uctxt 
+ * @return int 
+ */
+int KernelMsgqSend(int msgq_id, void *buf, int len, int prio, UserContext *uctxt);
+
+/**
+ * @brief Takes the highest priority message, waiting if there's none
+ * 
+ * @param msgq_id 
+ * @param buf 
+ * @param len 
+ * @param priop where the message's priority is saved, may be NULL
+ * @param uctxt 
+ * @return int length of the message, ERROR otherwise
+ */
+int KernelMsgqReceive(int msgq_id, void *buf, int len, int *priop, UserContext *uctxt);
+
+/**
+ * @brief Maps a fresh submission ring page into the caller's region 1
+ * 
+ * @param ringp where the address of the ring is saved
+ * @return int 
+ */
+int KernelRingSetup(ring_t **ringp);
+
+/**
+ * @brief Runs up to n queued ring operations, posting a completion for each
+ * 
+ * @param n 
+ * @param uctxt 
+ * @return int number of operations run, ERROR otherwise
+ */
+int KernelRingEnter(int n, UserContext *uctxt);
+
+/**
+ * @brief Registers the calling process as the server for service_id
+ * 
+ * @param service_id 
+ * @return int 
+ */
+int KernelRegister(unsigned int service_id);
+
+/**
+ * @brief Sends the 32 byte message at msg to process dest (or service -dest)
+ * and blocks until it replies. The reply overwrites msg.
+ * 
+ * @param msg 
+ * @param dest 
+ * @param uctxt 
+ * @return int 
+ */
+int KernelSend(void *msg, int dest, UserContext *uctxt);
+
+/**
+ * @brief Receives a message from any process into msg
+ * 
+ * @param msg 
+ * @param uctxt 
+ * @return int pid of the sender, ERROR otherwise
+ */
+int KernelReceive(void *msg, UserContext *uctxt);
+
+/**
+ * @brief Receives a message from pid into msg
+ * 
+ * @param msg 
+ * @param pid 
+ * @param uctxt 
+ * @return int pid of the sender, ERROR otherwise
+ */
+int KernelReceiveSpecific(void *msg, int pid, UserContext *uctxt);
+
+/**
+ * @brief Replies to pid, which must be blocked waiting on a reply from us
+ * 
+ * @param msg 
+ * @param pid 
+ * @return int 
+ */
+int KernelReply(void *msg, int pid);
+
+/**
+ * @brief Forwards msg to dest as if src had sent it
+ * 
+ * @param msg 
+ * @param dest 
+ * @param src 
+ * @return int 
+ */
+int KernelForward(void *msg, int dest, int src);
+
+/**
+ * @brief Copies len bytes from src in the address space of srcpid to dest in ours
+ * 
+ * @param srcpid 
+ * @param dest 
+ * @param src 
+ * @param len 
+ * @return int 
+ */
+int KernelCopyFrom(int srcpid, void *dest, void *src, int len);
+
+/**
+ * @brief Copies len bytes from src in our address space to dest in the one of dstpid
+ * 
+ * @param dstpid 
+ * @param dest 
+ * @param src 
+ * @param len 
+ * @return int 
+ */
+int KernelCopyTo(int dstpid, void *dest, void *src, int len);
+
+/**
+ * @brief Drops the message passing state of an exiting process
+ * 
+ * @param pcb 
+ */
+void IpcExit(pcb_t *pcb);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,226 @@
+/*
+ * tty.c
+ *
+ * terminal input rings, see tty.h
+ */
+
+#include <ylib.h>
+#include "tty.h"
+#include "kernel.h"
+#include "include.h"
+
+static tty_input_t tty_inputs[NUM_TERMINALS];
+static tty_output_t tty_outputs[NUM_TERMINALS];
+
+/**
+ * @brief sets up every terminal's input ring at the default size, cooked
+ * 
+ * @return int 0 if success, ERROR if malloc failed
+ */
+int tty_init(void) {
+    for (int i = 0; i < NUM_TERMINALS; i++) {
+        tty_input_t *in = &tty_inputs[i];
+        memset(in, 0, sizeof(tty_input_t));
+        in->buf = malloc(TTY_INPUT_DEFAULT_BYTES);
+        in->ends = malloc(TTY_INPUT_DEFAULT_BYTES * sizeof(unsigned int));
+        if (in->buf == NULL || in->ends == NULL) return ERROR;
+        in->cap = TTY_INPUT_DEFAULT_BYTES;
+        in->mode = TTY_COOKED;
+
+        tty_output_t *out = &tty_outputs[i];
+        memset(out, 0, sizeof(tty_output_t));
+        out->buf = malloc(TTY_OUTPUT_BYTES);
+        if (out->buf == NULL) return ERROR;
+    }
+    return 0;
+}
+
+/**
+ * @brief changes a terminal's mode, and its capacity unless capacity is 0
+ * 
+ * @param tty_id 
+ * @param mode TTY_COOKED or TTY_RAW
+ * @param capacity bytes, 0 to keep the current size
+ * @return int 0 if success, ERROR otherwise
+ */
+int tty_set_mode(int tty_id, int mode, int capacity) {
+    if (tty_id < 0 || tty_id >= NUM_TERMINALS || (mode != TTY_COOKED && mode != TTY_RAW)) {
+        return ERROR;
+    }
+    tty_input_t *in = &tty_inputs[tty_id];
+    int buffered = in->head - in->tail;
+    if (capacity != 0 && capacity != in->cap) {
+        if (capacity < TERMINAL_MAX_LINE || capacity > TTY_INPUT_MAX_BYTES || capacity < buffered) {
+            return ERROR;
+        }
+        char *buf = ReclaimingMalloc(capacity);
+        unsigned int *ends = ReclaimingMalloc(capacity * sizeof(unsigned int));
+        if (buf == NULL || ends == NULL) {
+            free(buf);
+            free(ends);
+            return ERROR;
+        }
+        // positions don't change, only where they live in the rings
+        for (unsigned int pos = in->tail; pos != in->head; pos++) {
+            buf[pos % capacity] = in->buf[pos % in->cap];
+        }
+        for (unsigned int n = in->ends_tail; n != in->ends_head; n++) {
+            ends[n % capacity] = in->ends[n % in->cap];
+        }
+        free(in->buf);
+        free(in->ends);
+        in->buf = buf;
+        in->ends = ends;
+        in->cap = capacity;
+    }
+    in->mode = mode;
+    return 0;
+}
+
+/**
+ * @brief buffers received bytes, dropping whatever doesn't fit
+ * 
+ * @param tty_id 
+ * @param src 
+ * @param len 
+ * @return int bytes kept
+ */
+int tty_input_put(int tty_id, char *src, int len) {
+    tty_input_t *in = &tty_inputs[tty_id];
+    int room = in->cap - (int) (in->head - in->tail);
+    int n = len < room ? len : room;
+    for (int i = 0; i < n; i++) {
+        in->buf[in->head % in->cap] = src[i];
+        in->head++;
+        if (src[i] == '\n') {
+            in->ends[in->ends_head % in->cap] = in->head;
+            in->ends_head++;
+        }
+    }
+    if (n < len) {
+        in->dropped += len - n;
+        TracePrintf(0, "tty_input_put: terminal %d full, dropped %d bytes\n", tty_id, len - n);
+    }
+    return n;
+}
+
+/**
+ * @brief how many bytes a read could take right now
+ * 
+ * @param tty_id 
+ * @return int 
+ */
+int tty_input_ready(int tty_id) {
+    tty_input_t *in = &tty_inputs[tty_id];
+    if (in->mode == TTY_COOKED && in->ends_tail != in->ends_head) {
+        return in->ends[in->ends_tail % in->cap] - in->tail;
+    }
+    // a partial line waits for its end, unless it fills the ring
+    if (in->mode == TTY_COOKED && in->head - in->tail < (unsigned int) in->cap) {
+        return 0;
+    }
+    return in->head - in->tail;
+}
+
+/**
+ * @brief copies out and consumes up to len of the bytes tty_input_ready
+ * counts
+ * 
+ * @param tty_id 
+ * @param dst 
+ * @param len 
+ * @return int bytes copied
+ */
+int tty_input_take(int tty_id, char *dst, int len) {
+    tty_input_t *in = &tty_inputs[tty_id];
+    int n = tty_input_ready(tty_id);
+    if (n > len) n = len;
+
+    // at most two pieces: up to the end of the ring, then from its start
+    int start = in->tail % in->cap;
+    int first = in->cap - start < n ? in->cap - start : n;
+    memcpy(dst, in->buf + start, first);
+    memcpy(dst + first, in->buf, n - first);
+    in->tail += n;
+
+    // forget the line ends we've read past
+    while (in->ends_tail != in->ends_head && (int) (in->ends[in->ends_tail % in->cap] - in->tail) <= 0) {
+        in->ends_tail++;
+    }
+    return n;
+}
+
+/**
+ * @brief queues bytes for output, as many as there's room for
+ * 
+ * @param tty_id 
+ * @param src 
+ * @param len 
+ * @return int bytes queued
+ */
+int tty_output_put(int tty_id, char *src, int len) {
+    tty_output_t *out = &tty_outputs[tty_id];
+    int n = tty_output_room(tty_id);
+    if (n > len) n = len;
+
+    int start = out->head % TTY_OUTPUT_BYTES;
+    int first = TTY_OUTPUT_BYTES - start < n ? TTY_OUTPUT_BYTES - start : n;
+    memcpy(out->buf + start, src, first);
+    memcpy(out->buf, src + first, n - first);
+    out->head += n;
+    return n;
+}
+
+/**
+ * @brief free space in a terminal's output ring
+ * 
+ * @param tty_id 
+ * @return int bytes
+ */
+int tty_output_room(int tty_id) {
+    return TTY_OUTPUT_BYTES - tty_output_pending(tty_id);
+}
+
+/**
+ * @brief queued bytes not yet transmitted, including those in flight
+ * 
+ * @param tty_id 
+ * @return int bytes
+ */
+int tty_output_pending(int tty_id) {
+    tty_output_t *out = &tty_outputs[tty_id];
+    return out->head - out->tail;
+}
+
+/**
+ * @brief starts transmitting the next line's worth of queued output if the
+ * terminal is idle. Only the part up to the end of the ring goes in one
+ * transmission, the hardware needs contiguous bytes.
+ * 
+ * @param tty_id 
+ */
+void tty_output_start(int tty_id) {
+    tty_output_t *out = &tty_outputs[tty_id];
+    int pending = tty_output_pending(tty_id);
+    if (out->in_flight > 0 || pending == 0 || ttyWriteTrackers[tty_id] != TERMINAL_OPEN) return;
+
+    int start = out->tail % TTY_OUTPUT_BYTES;
+    int n = pending < TERMINAL_MAX_LINE ? pending : TERMINAL_MAX_LINE;
+    if (n > TTY_OUTPUT_BYTES - start) n = TTY_OUTPUT_BYTES - start;
+    out->in_flight = n;
+    ttyWriteTrackers[tty_id] = TERMINAL_CLOSED;
+    TtyTransmit(tty_id, out->buf + start, n);
+}
+
+/**
+ * @brief retires the transmission that just completed and starts the next
+ * 
+ * @param tty_id 
+ */
+void tty_output_done(int tty_id) {
+    tty_output_t *out = &tty_outputs[tty_id];
+    out->tail += out->in_flight;
+    out->in_flight = 0;
+    ttyWriteTrackers[tty_id] = TERMINAL_OPEN;
+    tty_output_start(tty_id);
+}
@@ -0,0 +1,136 @@
+#ifndef __TTY_H_
+#define __TTY_H_
+
+#include <hardware.h>
+
+/*
+ * tty.h
+ *
+ * terminal input: each terminal keeps what it receives in a ring, and the
+ * offsets just past every buffered newline in a second ring, so finding
+ * the end of the next line never scans the bytes. Positions count bytes
+ * since the terminal started, byte n lives at buf[n % cap]. A TTY_COOKED
+ * terminal hands out at most one line per read, a TTY_RAW one hands out
+ * everything buffered.
+ *
+ * terminal output is write-behind: TtyWrite copies into the terminal's
+ * output ring and returns, and each transmit interrupt starts the next
+ * TtyTransmit straight from the ring. Bytes stay in the ring until their
+ * transmission completes.
+ */
+
+#define TTY_INPUT_DEFAULT_BYTES (4 * TERMINAL_MAX_LINE)
+#define TTY_INPUT_MAX_BYTES 65536
+#define TTY_OUTPUT_PAGES 2
+#define TTY_OUTPUT_BYTES (TTY_OUTPUT_PAGES * PAGESIZE)
+
+typedef struct tty_input {
+    char *buf;
+    int cap;                // bytes buf can hold
+    int mode;               // TTY_COOKED or TTY_RAW
+    unsigned int head;      // bytes ever received
+    unsigned int tail;      // bytes ever read
+    unsigned int *ends;     // positions just past each buffered newline, cap of them
+    unsigned int ends_head; // newlines ever received
+    unsigned int ends_tail; // newlines ever read past
+    unsigned int dropped;   // bytes lost to a full buffer
+} tty_input_t;
+
+typedef struct tty_output {
+    char *buf;              // TTY_OUTPUT_BYTES
+    unsigned int head;      // bytes ever queued
+    unsigned int tail;      // bytes ever transmitted
+    int in_flight;          // bytes handed to TtyTransmit, 0 if it's idle
+} tty_output_t;
+
+/**
+ * @brief sets up every terminal's input ring at the default size, cooked
+ * 
+ * @return int 0 if success, ERROR if malloc failed
+ */
+int tty_init(void);
+
+/**
+ * @brief changes a terminal's mode, and its capacity unless capacity is 0.
+ * Buffered input is kept, so the new capacity must hold it.
+ * 
+ * @param tty_id 
+ * @param mode TTY_COOKED or TTY_RAW
+ * @param capacity bytes, 0 to keep the current size
+ * @return int 0 if success, ERROR otherwise
+ */
+int tty_set_mode(int tty_id, int mode, int capacity);
+
+/**
+ * @brief buffers received bytes, dropping whatever doesn't fit
+ * 
+ * @param tty_id 
+ * @param src 
+ * @param len 
+ * @return int bytes kept
+ */
+int tty_input_put(int tty_id, char *src, int len);
+
+/**
+ * @brief how many bytes a read could take right now: the rest of the first
+ * line when cooked (nothing until a line is complete, unless a partial one
+ * fills the ring), everything when raw
+ * 
+ * @param tty_id 
+ * @return int 
+ */
+int tty_input_ready(int tty_id);
+
+/**
+ * @brief copies out and consumes up to len of the bytes tty_input_ready
+ * counts
+ * 
+ * @param tty_id 
+ * @param dst 
+ * @param len 
+ * @return int bytes copied
+ */
+int tty_input_take(int tty_id, char *dst, int len);
+
+/**
+ * @brief queues bytes for output, as many as there's room for
+ * 
+ * @param tty_id 
+ * @param src 
+ * @param len 
+ * @return int bytes queued
+ */
+int tty_output_put(int tty_id, char *src, int len);
+
+/**
+ * @brief free space in a terminal's output ring
+ * 
+ * @param tty_id 
+ * @return int bytes
+ */
+int tty_output_room(int tty_id);
+
+/**
+ * @brief queued bytes not yet transmitted, including those in flight
+ * 
+ * @param tty_id 
+ * @return int bytes
+ */
+int tty_output_pending(int tty_id);
+
+/**
+ * @brief starts transmitting the next line's worth of queued output if the
+ * terminal is idle
+ * 
+ * @param tty_id 
+ */
+void tty_output_start(int tty_id);
+
+/**
+ * @brief retires the transmission that just completed and starts the next
+ * 
+ * @param tty_id 
+ */
+void tty_output_done(int tty_id);
+
+#endif